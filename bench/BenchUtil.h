@@ -0,0 +1,86 @@
+#ifndef LIBNET_BENCH_BENCHUTIL_H
+#define LIBNET_BENCH_BENCHUTIL_H
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+// benchmark 程序共用的小工具，只在 bench/ 中使用
+
+namespace bench {
+
+inline double nowSeconds() {
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// 本进程消耗的 CPU 时间 (user + sys)
+inline double cpuSeconds() {
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) /
+               1e6;
+}
+
+// 阻塞地连接 127.0.0.1:port，服务端尚未启动时重试
+// rcvbuf > 0 时在连接前设置接收缓冲区大小
+inline int connectLoopback(uint16_t port, int rcvbuf = 0) {
+    struct sockaddr_in addr = {};
+    addr.sin_family         = AF_INET;
+    addr.sin_port           = htons(port);
+    addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+    for (int retry = 0; retry < 100; ++retry) {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (rcvbuf > 0) {
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        }
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ==
+            0) {
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            return fd;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    std::perror("connectLoopback");
+    std::exit(1);
+}
+
+inline bool readExactly(int fd, char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::read(fd, buf, len);
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline bool writeExactly(int fd, const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, buf, len);
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace bench
+
+#endif  // LIBNET_BENCH_BENCHUTIL_H
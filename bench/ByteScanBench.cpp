@@ -0,0 +1,134 @@
+// 协议扫描函数的吞吐量
+// 用法 : ByteScanBench [MB] [rounds]
+// 在由 HTTP 请求头拼成的缓冲区上，对比 scan:: 向量化实现与原先的 std::search /
+// 逐行查找写法，输出 GB/s
+
+#include "BenchUtil.h"
+#include "core/ByteScan.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace libnet;
+
+namespace {
+
+const char kCRLF[]     = "\r\n";
+const char kCRLFCRLF[] = "\r\n\r\n";
+
+const char kHeaders[] =
+    "GET /index.html?user=libnet&page=42 HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Cookie: session=0123456789abcdef0123456789abcdef; theme=dark\r\n"
+    "Connection: keep-alive\r\n";
+
+// 防止编译器把扫描结果优化掉
+volatile size_t g_sink;
+
+template <typename Scan>
+void run(const char* name, const std::string& data, int rounds, Scan&& scan) {
+    size_t       found = 0;
+    const double start = bench::nowSeconds();
+    for (int i = 0; i < rounds; ++i) {
+        found += scan(data.data(), data.data() + data.size());
+    }
+    const double seconds = bench::nowSeconds() - start;
+    g_sink = found;
+    std::printf("%-36s %7.2f GB/s  (%zu matches/round)\n", name,
+                static_cast<double>(data.size()) * rounds / seconds / 1e9,
+                found / static_cast<size_t>(rounds));
+}
+
+// 逐个找出所有 CRLF
+size_t crlfSearch(const char* begin, const char* end) {
+    size_t n = 0;
+    for (;;) {
+        const char* crlf = std::search(begin, end, kCRLF, kCRLF + 2);
+        if (crlf == end) {
+            return n;
+        }
+        ++n;
+        begin = crlf + 2;
+    }
+}
+
+size_t crlfScan(const char* begin, const char* end) {
+    size_t n = 0;
+    while (const char* crlf = scan::findCRLF(begin, end)) {
+        ++n;
+        begin = crlf + 2;
+    }
+    return n;
+}
+
+// 查找头部结束标志，缓冲区中没有 (最坏情况，扫描全部数据)
+size_t headerEndSearch(const char* begin, const char* end) {
+    return std::search(begin, end, kCRLFCRLF, kCRLFCRLF + 4) != end;
+}
+
+size_t headerEndScan(const char* begin, const char* end) {
+    return scan::findCRLFCRLF(begin, end) != nullptr;
+}
+
+// 拆分头部行 : 原先先找 CRLF 再在行内找 ':'，现在一次扫描同时找 ':' 与 '\r'
+size_t splitTwoPass(const char* begin, const char* end) {
+    size_t n = 0;
+    for (;;) {
+        const char* crlf = std::search(begin, end, kCRLF, kCRLF + 2);
+        if (crlf == end) {
+            return n;
+        }
+        n += std::find(begin, crlf, ':') != crlf;
+        begin = crlf + 2;
+    }
+}
+
+size_t splitOnePass(const char* begin, const char* end) {
+    static const scan::ByteSet kColonOrCR(":\r");
+    size_t                     n = 0;
+    for (;;) {
+        const char* p = scan::findAnyOf(begin, end, kColonOrCR);
+        if (p == nullptr) {
+            return n;
+        }
+        if (*p == ':') {
+            ++n;
+            p = scan::findCRLF(p, end);
+            if (p == nullptr) {
+                return n;
+            }
+        }
+        else if (p + 1 == end || p[1] != '\n') {
+            begin = p + 1;
+            continue;
+        }
+        begin = p + 2;
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+    const int    rounds    = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    std::string data;
+    while (data.size() < megabytes * 1024 * 1024) {
+        data += kHeaders;
+    }
+    std::printf("isa=%s buffer=%zu bytes rounds=%d\n", scan::isaName(),
+                data.size(), rounds);
+
+    run("findCRLF     std::search", data, rounds, crlfSearch);
+    run("findCRLF     scan", data, rounds, crlfScan);
+    run("findCRLFCRLF std::search", data, rounds, headerEndSearch);
+    run("findCRLFCRLF scan", data, rounds, headerEndScan);
+    run("header split two-pass", data, rounds, splitTwoPass);
+    run("header split findAnyOf", data, rounds, splitOnePass);
+}
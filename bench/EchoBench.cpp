@@ -0,0 +1,255 @@
+// echo 服务端在不同模式下的吞吐量、往返延迟与 Poller 系统调用次数
+// 用法 : EchoBench [conns] [msgSize] [seconds]
+// 每个模式起一个 echo TcpServer (各自独立的 I/O loop)，客户端线程以 conns 个
+// 连接 ping-pong : 每个连接收齐上一条消息的回显后再发下一条。
+// 忙轮询模式另外输出服务端 loop 的自旋与阻塞时间，用于权衡 CPU 与 p99 延迟；
+// 延迟敏感的场景可用 EchoBench 1 64 观察。
+// io_uring 模式的服务端 loop 使用 UringPoller 的完成模式 (内核不支持时退回
+// epoll)，wait 为 io_uring_enter 次数，读写都由完成事件送达，不再有 read/write
+
+#include "BenchUtil.h"
+#include "core/EventLoop.h"
+#include "core/Poller.h"
+#include "core/TcpConnection.h"
+#include "core/TcpServer.h"
+#include "logger/Logger.h"
+#include "utils/Histogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/epoll.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace libnet;
+
+namespace {
+
+struct Mode
+{
+    const char* name;
+    bool        edgeTriggered;
+    Nanoseconds busyPoll;
+    bool        uring;
+};
+
+const Mode kModes[] = {
+    { "level-triggered", false, 0us, false },
+    { "edge-triggered", true, 0us, false },
+    { "busy-poll 50us", false, 50us, false },
+    { "io_uring", false, 0us, true },
+};
+
+struct ServerStats
+{
+    Poller::Stats            poller;
+    EventLoop::BusyPollStats busyPoll;
+    uint64_t                 readCalls;   // 服务端连接的 read/readv 次数
+    uint64_t                 writeCalls;  // 服务端连接的 write/writev 次数
+};
+
+struct Result
+{
+    double      seconds;
+    uint64_t    messages;
+    ServerStats server;  // 服务端 loop 在本轮中的增量
+};
+
+// 服务端连接所在的 loop，客户端在每轮开始前清空
+std::atomic<EventLoop*> g_serverLoop(nullptr);
+// 所有服务端连接，断开后也保留以便统计
+std::mutex                    g_connsMutex;
+std::vector<TcpConnectionPtr> g_conns;
+
+// Poller 的统计只能在 loop 线程中读取
+// 调用前客户端已发出消息，服务端收到后即可得知其 loop
+ServerStats serverStats() {
+    EventLoop* loop;
+    while ((loop = g_serverLoop.load()) == nullptr) {
+        std::this_thread::yield();
+    }
+    std::promise<ServerStats> stats;
+    loop->runInLoop([loop, &stats] {
+        ServerStats result = { loop->poller()->stats(), loop->busyPollStats(),
+                               0, 0 };
+        std::lock_guard<std::mutex> lock(g_connsMutex);
+        for (const TcpConnectionPtr& conn : g_conns) {
+            if (conn->getLoop() == loop) {
+                result.readCalls += conn->readSyscalls();
+                result.writeCalls += conn->writeSyscalls();
+            }
+        }
+        stats.set_value(result);
+    });
+    return stats.get_future().get();
+}
+
+Result runClient(uint16_t   port,
+                 int        numConns,
+                 size_t     msgSize,
+                 double     duration,
+                 Histogram& latency) {
+    struct Conn
+    {
+        int    fd;
+        size_t pending;  // 尚未收到的回显字节数
+        double sentAt;
+    };
+    g_serverLoop = nullptr;
+    const std::string message(msgSize, 'e');
+    std::vector<char> buf(256 * 1024);
+    std::vector<Conn> conns(static_cast<size_t>(numConns));
+    const int         epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    for (size_t i = 0; i < conns.size(); ++i) {
+        conns[i].fd      = bench::connectLoopback(port);
+        conns[i].pending = msgSize;
+        conns[i].sentAt  = bench::nowSeconds();
+        struct epoll_event ev;
+        ev.events   = EPOLLIN;
+        ev.data.u64 = i;
+        ::epoll_ctl(epfd, EPOLL_CTL_ADD, conns[i].fd, &ev);
+        bench::writeExactly(conns[i].fd, message.data(), msgSize);
+    }
+
+    Result             result   = {};
+    const ServerStats  before   = serverStats();
+    const double       start    = bench::nowSeconds();
+    const double       deadline = start + duration;
+    struct epoll_event events[64];
+    while (bench::nowSeconds() < deadline) {
+        const int n = ::epoll_wait(epfd, events, 64, 100);
+        for (int i = 0; i < n; ++i) {
+            Conn&   conn = conns[events[i].data.u64];
+            ssize_t got  = ::recv(conn.fd, buf.data(),
+                                  std::min(buf.size(), conn.pending),
+                                  MSG_DONTWAIT);
+            if (got <= 0) {
+                continue;
+            }
+            conn.pending -= static_cast<size_t>(got);
+            if (conn.pending == 0) {
+                const double now = bench::nowSeconds();
+                latency.record(static_cast<int64_t>((now - conn.sentAt) * 1e9));
+                ++result.messages;
+                conn.pending = msgSize;
+                conn.sentAt  = now;
+                bench::writeExactly(conn.fd, message.data(), msgSize);
+            }
+        }
+    }
+    result.seconds = bench::nowSeconds() - start;
+
+    const ServerStats after = serverStats();
+    Poller::Stats&    poller = result.server.poller;
+    poller.pollCalls  = after.poller.pollCalls - before.poller.pollCalls;
+    poller.ctlCalls   = after.poller.ctlCalls - before.poller.ctlCalls;
+    poller.ctlAvoided = after.poller.ctlAvoided - before.poller.ctlAvoided;
+    poller.completions =
+        after.poller.completions - before.poller.completions;
+    EventLoop::BusyPollStats& busyPoll = result.server.busyPoll;
+    busyPoll.spinTime  = after.busyPoll.spinTime - before.busyPoll.spinTime;
+    busyPoll.sleepTime = after.busyPoll.sleepTime - before.busyPoll.sleepTime;
+    busyPoll.spinHits  = after.busyPoll.spinHits - before.busyPoll.spinHits;
+    busyPoll.sleeps    = after.busyPoll.sleeps - before.busyPoll.sleeps;
+    result.server.readCalls  = after.readCalls - before.readCalls;
+    result.server.writeCalls = after.writeCalls - before.writeCalls;
+    for (const Conn& conn : conns) {
+        ::close(conn.fd);
+    }
+    ::close(epfd);
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int    numConns = argc > 1 ? std::atoi(argv[1]) : 32;
+    const size_t msgSize  = argc > 2 ? std::strtoul(argv[2], nullptr, 10)
+                                     : 16 * 1024;
+    const double duration = argc > 3 ? std::atof(argv[3]) : 3.0;
+    Logger::setLogLevel(Logger::ERROR);
+
+    EventLoop                               loop;
+    std::vector<std::unique_ptr<TcpServer>> servers;
+    const uint16_t                          basePort = 19710;
+    for (const Mode& mode : kModes) {
+        const auto port = static_cast<uint16_t>(basePort + servers.size());
+        // 不使用 SO_REUSEPORT : 连接交给 server 自己的 I/O 线程，
+        // 各模式的 loop 设置互不影响
+        auto server =
+            std::make_unique<TcpServer>(&loop, InetAddress(port), false, 0s);
+        server->setNumThreads(1);
+        server->setEdgeTriggered(mode.edgeTriggered);
+        server->setBusyPoll(mode.busyPoll);
+        server->setConnectionCallback([](const TcpConnectionPtr& conn) {
+            if (conn->connected()) {
+                std::lock_guard<std::mutex> lock(g_connsMutex);
+                g_conns.push_back(conn);
+            }
+        });
+        server->setMessageCallback(
+            [](const TcpConnectionPtr& conn, Buffer& buffer) {
+                g_serverLoop = conn->getLoop();
+                conn->send(buffer);
+            });
+        // I/O loop 在 start() 中创建，Poller 的实现此时选定
+        if (mode.uring) {
+            ::setenv("LIBNET_USE_URING", "1", 1);
+        }
+        server->start();
+        ::unsetenv("LIBNET_USE_URING");
+        servers.push_back(std::move(server));
+    }
+
+    std::printf("conns=%d msgSize=%zu duration=%.1fs\n", numConns, msgSize,
+                duration);
+    std::thread client([&] {
+        for (size_t i = 0; i < servers.size(); ++i) {
+            const auto port = static_cast<uint16_t>(basePort + i);
+            Histogram  latency;
+            const Result result =
+                runClient(port, numConns, msgSize, duration, latency);
+            const double mb =
+                static_cast<double>(result.messages * msgSize) / (1 << 20);
+            const auto perMessage = [&result](uint64_t calls) {
+                return static_cast<double>(calls) / result.messages;
+            };
+            std::printf("%-16s %10.0f msg/s %9.1f MB/s  rtt p50=%.1fus "
+                        "p99=%.1fus  per msg: %.3f wait %.3f ctl "
+                        "(%.3f avoided) %.3f read %.3f write "
+                        "%.3f completions\n",
+                        kModes[i].name,
+                        static_cast<double>(result.messages) / result.seconds,
+                        mb / result.seconds, latency.percentile(0.5) / 1e3,
+                        latency.percentile(0.99) / 1e3,
+                        perMessage(result.server.poller.pollCalls),
+                        perMessage(result.server.poller.ctlCalls),
+                        perMessage(result.server.poller.ctlAvoided),
+                        perMessage(result.server.readCalls),
+                        perMessage(result.server.writeCalls),
+                        perMessage(result.server.poller.completions));
+            const EventLoop::BusyPollStats& busyPoll = result.server.busyPoll;
+            if (kModes[i].busyPoll.count() > 0) {
+                std::printf("%-16s spin %.3fs (%lu hits)  sleep %.3fs "
+                            "(%lu sleeps)\n",
+                            "", busyPoll.spinTime.count() / 1e9,
+                            static_cast<unsigned long>(busyPoll.spinHits),
+                            busyPoll.sleepTime.count() / 1e9,
+                            static_cast<unsigned long>(busyPoll.sleeps));
+            }
+        }
+        loop.quit();
+    });
+    loop.loop();
+    client.join();
+    // TcpServer 不支持在还有连接时析构，直接退出
+    std::fflush(stdout);
+    ::_exit(0);
+}
@@ -0,0 +1,112 @@
+// 空闲连接占用的 Buffer 内存
+// 用法 : IdleConnectionBench [numConns] [replySize]
+// 每个连接发出一条请求并收完 replySize 字节的回复后保持空闲，统计 loop 的
+// BufferPool 中仍被占用的字节数，对比默认设置与 setReleaseIdleBuffers(true)。
+// 回复需大于 socket 发送缓冲区 (tcp_wmem)，才会经过输出队列
+
+#include "BenchUtil.h"
+#include "core/BufferPool.h"
+#include "core/EventLoop.h"
+#include "core/TcpConnection.h"
+#include "core/TcpServer.h"
+#include "logger/Logger.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace libnet;
+
+namespace {
+
+struct Mode
+{
+    const char*              name;
+    uint16_t                 port;
+    std::atomic<BufferPool*> pool{ nullptr };
+};
+
+// 发出一条请求并收完回复
+int sendRequest(const Mode& mode, std::string& reply) {
+    const std::string request(200, 'x');
+    int               fd = bench::connectLoopback(mode.port);
+    if (!bench::writeExactly(fd, request.data(), request.size()) ||
+        !bench::readExactly(fd, &reply[0], reply.size())) {
+        std::fprintf(stderr, "request failed\n");
+        std::exit(1);
+    }
+    return fd;
+}
+
+void measure(Mode& mode, int numConns, size_t replySize) {
+    std::string reply(replySize, '\0');
+    // 先以一个连接找到服务端 loop 的 BufferPool
+    ::close(sendRequest(mode, reply));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // 两个 server 可能共用同一个 loop 的 BufferPool，只计本轮的增量
+    const uint64_t before = mode.pool.load()->stats().inUseBytes;
+
+    std::vector<int> fds;
+    fds.reserve(static_cast<size_t>(numConns));
+    for (int i = 0; i < numConns; ++i) {
+        fds.push_back(sendRequest(mode, reply));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    const uint64_t after = mode.pool.load()->stats().inUseBytes;
+    std::printf("%-20s %6d conns : %8.1f bytes/conn in use\n", mode.name,
+                numConns, static_cast<double>(after - before) / numConns);
+    for (int fd : fds) {
+        ::close(fd);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int    numConns  = argc > 1 ? std::atoi(argv[1]) : 200;
+    const size_t replySize = argc > 2 ? std::strtoul(argv[2], nullptr, 10)
+                                      : 8 * 1024 * 1024;
+    const std::string reply(replySize, 'r');
+    Logger::setLogLevel(Logger::ERROR);
+
+    EventLoop loop;
+    Mode      keep{ "default", 19701 };
+    Mode      release{ "releaseIdleBuffers", 19702 };
+
+    // 不检测空闲超时，连接一直保持
+    TcpServer keepServer(&loop, InetAddress(keep.port), true, 0s);
+    TcpServer releaseServer(&loop, InetAddress(release.port), true, 0s);
+    releaseServer.setReleaseIdleBuffers(true);
+    const std::pair<TcpServer*, Mode*> servers[] = {
+        { &keepServer, &keep }, { &releaseServer, &release }
+    };
+    for (const auto& server : servers) {
+        Mode* mode = server.second;
+        server.first->setNumThreads(1);
+        server.first->setMessageCallback(
+            [mode, &reply](const TcpConnectionPtr& conn, Buffer& buffer) {
+                mode->pool = conn->getLoop()->bufferPool().get();
+                buffer.retrieveAll();
+                conn->send(reply);
+            });
+        server.first->start();
+    }
+
+    std::printf("sizeof(TcpConnection) = %zu bytes\n", sizeof(TcpConnection));
+    std::thread client([&] {
+        measure(keep, numConns, replySize);
+        measure(release, numConns, replySize);
+        loop.quit();
+    });
+    loop.loop();
+    client.join();
+    // TcpServer 不支持在还有连接时析构，直接退出
+    std::fflush(stdout);
+    ::_exit(0);
+}
@@ -0,0 +1,178 @@
+// 跨线程投递 task 的吞吐量
+// 用法 : TaskQueueBench [tasksPerProducer] [producers...]
+// N 个生产者线程同时向一个 loop 投递空 task，对比 EventLoop::queueInLoop
+// (无锁 MPSC 队列，一次 drain 之后只有第一个投递者写 eventfd) 与原先的
+// mutex + vector 实现 (每次投递都写 eventfd)，输出吞吐量与每千个 task 中
+// loop 取出批次的次数 (queueInLoop 写 eventfd 的次数不超过它)
+
+#include "BenchUtil.h"
+#include "core/EventLoop.h"
+#include "core/Poller.h"
+#include "logger/Logger.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace libnet;
+
+namespace {
+
+struct Result
+{
+    double   seconds;
+    uint64_t batches;  // loop 取出 task 的轮数
+};
+
+// 原先的实现 : 投递时加锁放入 vector 并写 eventfd，loop 线程交换出整个
+// vector 后执行
+class MutexTaskQueue
+{
+public:
+    MutexTaskQueue() : wakeupFd_(::eventfd(0, EFD_CLOEXEC)) {}
+    ~MutexTaskQueue() { ::close(wakeupFd_); }
+
+    void queueInLoop(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        uint64_t one = 1;
+        ::write(wakeupFd_, &one, sizeof(one));
+    }
+
+    // 执行 total 个 task 后返回，返回取出批次的次数
+    uint64_t run(uint64_t total) {
+        uint64_t                           executed = 0;
+        uint64_t                           batches  = 0;
+        std::vector<std::function<void()>> tasks;
+        while (executed < total) {
+            uint64_t count;
+            ::read(wakeupFd_, &count, sizeof(count));
+            ++batches;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks.swap(tasks_);
+            }
+            for (auto& task : tasks) {
+                task();
+            }
+            executed += tasks.size();
+            tasks.clear();
+        }
+        return batches;
+    }
+
+private:
+    const int                          wakeupFd_;
+    std::mutex                         mutex_;
+    std::vector<std::function<void()>> tasks_;
+};
+
+template <typename Post>
+double produce(int producers, uint64_t perProducer, Post&& post) {
+    std::atomic<bool>        go(false);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; ++i) {
+        threads.emplace_back([&] {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            for (uint64_t j = 0; j < perProducer; ++j) {
+                post();
+            }
+        });
+    }
+    const double start = bench::nowSeconds();
+    go                 = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return start;
+}
+
+Result runEventLoop(int producers, uint64_t perProducer) {
+    const uint64_t total = perProducer * static_cast<uint64_t>(producers);
+    std::atomic<uint64_t>    executed(0);
+    std::promise<EventLoop*> started;
+    std::thread              thread([&] {
+        EventLoop loop;
+        started.set_value(&loop);
+        loop.loop();
+    });
+    EventLoop* loop = started.get_future().get();
+
+    const auto pollCalls = [loop] {
+        std::promise<uint64_t> calls;
+        loop->runInLoop([loop, &calls] {
+            calls.set_value(loop->poller()->stats().pollCalls);
+        });
+        return calls.get_future().get();
+    };
+    const uint64_t before = pollCalls();
+    const double   start  = produce(producers, perProducer, [&] {
+        loop->queueInLoop(
+            [&executed] { executed.fetch_add(1, std::memory_order_relaxed); });
+    });
+    while (executed.load() < total) {
+        std::this_thread::yield();
+    }
+    Result result  = {};
+    result.seconds = bench::nowSeconds() - start;
+    result.batches = pollCalls() - before;
+    loop->quit();
+    thread.join();
+    return result;
+}
+
+Result runMutexQueue(int producers, uint64_t perProducer) {
+    const uint64_t total = perProducer * static_cast<uint64_t>(producers);
+    MutexTaskQueue queue;
+    uint64_t       executed = 0;
+    Result         result   = {};
+    std::thread    consumer([&] { result.batches = queue.run(total); });
+    const double   start = produce(producers, perProducer, [&] {
+        queue.queueInLoop([&executed] { ++executed; });
+    });
+    consumer.join();
+    result.seconds = bench::nowSeconds() - start;
+    return result;
+}
+
+void report(const char* name, uint64_t total, const Result& result) {
+    std::printf("  %-22s %7.2f Mtasks/s  %8.2f batches/1k tasks\n", name,
+                static_cast<double>(total) / result.seconds / 1e6,
+                static_cast<double>(result.batches) * 1000 /
+                    static_cast<double>(total));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const uint64_t perProducer =
+        argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    std::vector<int> counts;
+    for (int i = 2; i < argc; ++i) {
+        counts.push_back(std::atoi(argv[i]));
+    }
+    if (counts.empty()) {
+        counts = { 1, 4, 16, 32 };
+    }
+    Logger::setLogLevel(Logger::ERROR);
+
+    std::printf("tasks per producer=%lu\n",
+                static_cast<unsigned long>(perProducer));
+    for (int producers : counts) {
+        const uint64_t total = perProducer * static_cast<uint64_t>(producers);
+        std::printf("producers=%d\n", producers);
+        report("queueInLoop", total, runEventLoop(producers, perProducer));
+        report("mutex + vector", total, runMutexQueue(producers, perProducer));
+    }
+}
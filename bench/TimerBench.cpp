@@ -0,0 +1,103 @@
+// 小根堆与分层时间轮两种 TimerStore 的操作开销
+// 用法 : TimerBench [numTimers] [resolutionUs]
+// 模拟大量连接的空闲超时 : numTimers 个 1~60s 后到期的定时器，依次测量
+// 加入、整体重置 (每个连接收到数据后推迟超时)、取消一半、按 1ms 的步长
+// 推进 61s 取出全部到期定时器，输出每个定时器每次操作的平均耗时
+
+#include "BenchUtil.h"
+#include "core/TimerHeap.h"
+#include "core/TimingWheel.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace libnet;
+
+namespace {
+
+const int64_t kMinTimeout  = 1000000000;   // 1s
+const int64_t kTimeoutSpan = 59000000000;  // 1s ~ 60s
+const int     kRearmRounds = 5;
+
+void run(TimerStore& store, Timestamp base, size_t numTimers) {
+    std::mt19937_64 rng(42);
+    const auto      timeout = [&rng] {
+        return kMinTimeout + static_cast<int64_t>(rng() % kTimeoutSpan);
+    };
+    std::vector<std::unique_ptr<Timer>> timers;
+    timers.reserve(numTimers);
+    for (size_t i = 0; i < numTimers; ++i) {
+        timers.push_back(std::make_unique<Timer>());
+        timers.back()->setWhen(base + Nanoseconds(timeout()));
+    }
+    const auto perTimer = [](double seconds, size_t count) {
+        return seconds * 1e9 / static_cast<double>(count);
+    };
+
+    double start = bench::nowSeconds();
+    for (auto& timer : timers) {
+        store.add(timer.get());
+    }
+    const double add = perTimer(bench::nowSeconds() - start, numTimers);
+
+    // 每轮过去 10ms，所有定时器重新计时
+    int64_t               now = 0;
+    TimerStore::TimerList expired;
+    start = bench::nowSeconds();
+    for (int round = 0; round < kRearmRounds; ++round) {
+        now += 10000000;
+        store.takeExpired(base + Nanoseconds(now), expired);
+        for (auto& timer : timers) {
+            store.update(timer.get(), base + Nanoseconds(now + timeout()));
+        }
+    }
+    const double rearm =
+        perTimer(bench::nowSeconds() - start, numTimers * kRearmRounds);
+
+    start = bench::nowSeconds();
+    for (size_t i = 0; i < numTimers / 2; ++i) {
+        store.remove(timers[i].get());
+    }
+    const double cancel = perTimer(bench::nowSeconds() - start, numTimers / 2);
+
+    // 以 1ms 的步长推进，相当于 loop 每毫秒处理一次定时器
+    const int64_t end = now + kMinTimeout + kTimeoutSpan + 1000000000;
+    size_t        polls = 0;
+    expired.clear();
+    start = bench::nowSeconds();
+    for (; now <= end; now += 1000000, ++polls) {
+        store.takeExpired(base + Nanoseconds(now), expired);
+    }
+    const double expireSeconds = bench::nowSeconds() - start;
+
+    std::printf("%-6s add %6.1f ns  rearm %6.1f ns  cancel %6.1f ns  "
+                "expire %6.1f ns (%zu fired, %zu polls in %.0f ms)\n",
+                store.name(), add, rearm, cancel,
+                perTimer(expireSeconds, std::max<size_t>(expired.size(), 1)),
+                expired.size(), polls, expireSeconds * 1e3);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t numTimers =
+        argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const Nanoseconds resolution =
+        Microseconds(argc > 2 ? std::atol(argv[2]) : 1000);
+
+    std::printf("timers=%zu wheel resolution=%ldus\n", numTimers,
+                static_cast<long>(resolution.count() / 1000));
+    const Timestamp base = clock::now();
+    {
+        TimerHeap heap;
+        run(heap, base, numTimers);
+    }
+    {
+        TimingWheel wheel(base, resolution);
+        run(wheel, base, numTimers);
+    }
+}
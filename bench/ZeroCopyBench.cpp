@@ -0,0 +1,178 @@
+// MSG_ZEROCOPY 与普通发送的对比
+// 用法 : ZeroCopyBench [payloadKB] [totalMB] [host port]
+// 以 BufferChain 反复发送同一个共享 payload，统计吞吐量与发送线程每 GB 消耗的
+// CPU 时间。默认发往本进程内的 loopback 接收端 : loopback 上内核在投递时退回
+// 拷贝 (完成通知带 SO_EE_CODE_ZEROCOPY_COPIED)，拷贝算在接收线程上，吞吐量只会
+// 下降；给出 host port
+// 时发往外部的接收端 (两种模式各连接一次，如 socat -u TCP-LISTEN:port,fork
+// /dev/null)，经过真实网卡才能看到收益
+
+#include "BenchUtil.h"
+#include "core/BufferChain.h"
+#include "core/ZeroCopyGraveyard.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+
+#ifndef SO_ZEROCOPY
+#    define SO_ZEROCOPY 60
+#endif
+
+using namespace libnet;
+
+namespace {
+
+struct Result
+{
+    double   seconds;
+    double   cpuSeconds;  // 发送线程
+    uint64_t zeroCopySends;
+    uint64_t copied;  // 内核退回拷贝的完成通知数
+};
+
+double threadCpuSeconds() {
+    struct rusage usage;
+    ::getrusage(RUSAGE_THREAD, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) /
+               1e6;
+}
+
+int connectTo(const char* host, uint16_t port) {
+    struct sockaddr_in addr = {};
+    addr.sin_family         = AF_INET;
+    addr.sin_port           = htons(port);
+    if (::inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        std::fprintf(stderr, "bad address %s\n", host);
+        std::exit(1);
+    }
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::perror("connect");
+        std::exit(1);
+    }
+    return fd;
+}
+
+// 在 fd (阻塞) 上发送 total 字节，threshold 为 0 时不使用零拷贝
+Result sendAll(int fd, const BufferChain::Payload& payload, size_t total,
+               size_t threshold) {
+    Result      result = {};
+    BufferChain chain;
+    if (threshold > 0) {
+        int on = 1;
+        if (::setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) != 0) {
+            std::perror("SO_ZEROCOPY");
+            std::exit(1);
+        }
+        chain.setZeroCopyThreshold(threshold);
+    }
+    const double start    = bench::nowSeconds();
+    const double cpuStart = threadCpuSeconds();
+    size_t       sent     = 0;
+    int          savedErrno;
+    while (sent < total) {
+        if (chain.empty()) {
+            chain.append(payload);
+        }
+        ssize_t n = chain.writeFd(fd, &savedErrno);
+        if (n < 0) {
+            errno = savedErrno;
+            std::perror("writeFd");
+            std::exit(1);
+        }
+        sent += static_cast<size_t>(n);
+        readZeroCopyCompletions(fd, [&](uint32_t hi, bool copied) {
+            chain.releaseZeroCopy(hi);
+            result.copied += copied;
+        });
+    }
+    // 等待全部完成通知，payload 才能被修改或释放
+    while (chain.pinnedCount() > 0) {
+        readZeroCopyCompletions(fd, [&](uint32_t hi, bool copied) {
+            chain.releaseZeroCopy(hi);
+            result.copied += copied;
+        });
+        std::this_thread::yield();
+    }
+    result.seconds       = bench::nowSeconds() - start;
+    result.cpuSeconds    = threadCpuSeconds() - cpuStart;
+    result.zeroCopySends = chain.zeroCopySends();
+    return result;
+}
+
+void report(const char* name, size_t total, const Result& result) {
+    const double gigabytes = static_cast<double>(total) / 1e9;
+    std::printf("%-10s %7.2f GB/s  %6.3f cpu-s/GB  zerocopy sends=%lu "
+                "copied=%lu\n",
+                name, gigabytes / result.seconds,
+                result.cpuSeconds / gigabytes,
+                static_cast<unsigned long>(result.zeroCopySends),
+                static_cast<unsigned long>(result.copied));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t payloadSize =
+        (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024) * 1024;
+    const size_t total =
+        (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2048) * 1024 * 1024;
+    const char* host = argc > 4 ? argv[3] : nullptr;
+    const auto  port =
+        static_cast<uint16_t>(argc > 4 ? std::atoi(argv[4]) : 19703);
+
+    auto payload = std::make_shared<const std::string>(payloadSize, 'z');
+
+    int listener = -1;
+    if (host == nullptr) {
+        listener                = ::socket(AF_INET, SOCK_STREAM, 0);
+        int on                  = 1;
+        struct sockaddr_in addr = {};
+        addr.sin_family         = AF_INET;
+        addr.sin_port           = htons(port);
+        addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+        ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (::bind(listener, reinterpret_cast<sockaddr*>(&addr),
+                   sizeof(addr)) != 0 ||
+            ::listen(listener, 4) != 0) {
+            std::perror("listen");
+            return 1;
+        }
+    }
+
+    std::printf("payload=%zu bytes total=%zu MB %s\n", payloadSize,
+                total >> 20, host != nullptr ? host : "loopback");
+    for (size_t threshold : { size_t(0), payloadSize }) {
+        std::thread receiver;
+        int         fd;
+        if (host == nullptr) {
+            receiver = std::thread([listener] {
+                int     conn = ::accept(listener, nullptr, nullptr);
+                char    buf[256 * 1024];
+                ssize_t n;
+                while ((n = ::read(conn, buf, sizeof(buf))) > 0) {
+                }
+                ::close(conn);
+            });
+            fd = bench::connectLoopback(port);
+        }
+        else {
+            fd = connectTo(host, port);
+        }
+        const Result result = sendAll(fd, payload, total, threshold);
+        ::close(fd);
+        if (receiver.joinable()) {
+            receiver.join();
+        }
+        report(threshold > 0 ? "zerocopy" : "copy", total, result);
+    }
+    if (listener >= 0) {
+        ::close(listener);
+    }
+}
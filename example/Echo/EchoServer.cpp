@@ -1,4 +1,5 @@
 #include <cstddef>
+#include <cstring>
 #include <functional>
 
 #include "EchoServer.h"
@@ -13,10 +14,9 @@ EchoServer::EchoServer(EventLoop* loop,
                        size_t numThread,
                        Nanoseconds timeout)
     : loop_(loop),
-      server_(loop, addr),
+      server_(loop, addr, true, timeout),
       numThread_(numThread),
-      timeout_(timeout),
-      timer_(loop_->runEvery(timeout_, [this]() { this->onTimeout(); })) {
+      timeout_(timeout) {
     server_.setConnectionCallback(
         std::bind(&EchoServer::onConnection, this, _1));
 
@@ -26,10 +26,6 @@ EchoServer::EchoServer(EventLoop* loop,
         std::bind(&EchoServer::onWriteComplete, this, _1));
 }
 
-EchoServer::~EchoServer() {
-    loop_->cancelTimer(timer_);
-}
-
 void EchoServer::start() {
     server_.setNumThreads(numThread_);
     server_.start();
@@ -39,57 +35,43 @@ void EchoServer::onConnection(const TcpConnectionPtr& conn) {
     if (conn->connected()) {
         conn->setHighWaterMarkCallback(
             std::bind(&EchoServer::onHighWaterMark, this, _1, _2), 1024);
-        expireAfter(conn, timeout_);
-    }
-    else {
-        connections_.erase(conn);
     }
 }
 
 void EchoServer::onMessage(const TcpConnectionPtr& conn, Buffer& buffer) {
     conn->send(buffer);
-    expireAfter(conn, timeout_);
 }
 
 void EchoServer::onHighWaterMark(const TcpConnectionPtr& conn, size_t mark) {
     LOG_INFO << "Reached High water mark " << mark << " bytes, stop read";
     conn->stopRead();
-    expireAfter(conn, 2 * timeout_);
+    conn->setIdleTimeout(2 * timeout_);
 }
 
 void EchoServer::onWriteComplete(const TcpConnectionPtr& conn) {
     if (!conn->isReading()) {
         LOG_INFO << "Write complete, start read";
         conn->startRead();
-        expireAfter(conn, timeout_);
+        conn->setIdleTimeout(timeout_);
     }
 }
 
-void EchoServer::expireAfter(const TcpConnectionPtr& conn,
-                             const Nanoseconds interval) {
-    connections_[conn] = clock::nowAfter(interval);
-}
-
-void EchoServer::onTimeout() {
-    for (auto it = connections_.begin(); it != connections_.end();) {
-        if (it->second <= clock::now()) {
-            LOG_INFO << "connection " << it->first->name()
-                     << "  timeout force close";
-            it->first->forceClose();
-            it = connections_.erase(it);
+int main(int argc, char* argv[]) {
+    Logger::setLogLevel(Logger::TRACE);
+    bool edgeTriggered = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-e") == 0) {
+            edgeTriggered = true;
         }
         else {
-            ++it;
+            LOG_ERROR << "main() : argv not recognized!";
         }
     }
-}
-
-int main() {
-    Logger::setLogLevel(Logger::TRACE);
     EventLoop loop;
     InetAddress addr(9877);
 
     EchoServer server(&loop, addr, 1, 5s);
+    server.setEdgeTriggered(edgeTriggered);
     server.start();
 
     loop.runAfter(1000s, [&]() {
@@ -1,6 +1,5 @@
 #include "core/TcpConnection.h"
 #include "core/TcpServer.h"
-#include <map>
 
 using namespace libnet;
 
@@ -11,9 +10,10 @@ public:
                const InetAddress& addr,
                size_t             numThread = 1,
                Nanoseconds        timeout   = 5s);
-    ~EchoServer();
 
     void start();
+    // 连接以边沿触发模式注册，用于和默认的水平触发对比
+    void setEdgeTriggered(bool on) { server_.setEdgeTriggered(on); }
 
     void onConnection(const TcpConnectionPtr& conn);
     void onMessage(const TcpConnectionPtr& conn, Buffer& buffer);
@@ -21,17 +21,8 @@ public:
     void onWriteComplete(const TcpConnectionPtr& conn);
 
 private:
-    void expireAfter(const TcpConnectionPtr& conn, const Nanoseconds interval);
-
-    void onTimeout();
-
-private:
-    using ConnectionList = std::map<TcpConnectionPtr, Timestamp>;
-
     EventLoop*        loop_;
     TcpServer         server_;
     const size_t      numThread_;
     const Nanoseconds timeout_;
-    Timer::sptr       timer_;
-    ConnectionList    connections_;
 };
\ No newline at end of file
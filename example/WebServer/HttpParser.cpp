@@ -1,11 +1,19 @@
 #include "HttpParser.h"
 #include "core/Buffer.h"
+#include "core/ByteScan.h"
 
 #include <algorithm>
 
 using namespace webserver;
 using namespace libnet;
 
+namespace {
+
+// 头部行中 ':' 与行尾 '\r' 一次扫描同时定位
+const scan::ByteSet kColonOrCR(":\r");
+
+}  // anonymous namespace
+
 bool HttpParser::parseRequest(Buffer& buf) {
     bool ok = true;
     bool hasMore = true;
@@ -28,10 +36,13 @@ bool HttpParser::parseRequest(Buffer& buf) {
             }
         }
         else if (state_ == kExpectHeaders) {
-            const char* crlf = buf.findCRLF();
+            const char* delim =
+                scan::findAnyOf(buf.peek(), buf.beginWrite(), kColonOrCR);
+            const char* crlf = delim ? buf.findCRLF(delim) : nullptr;
             if (crlf) {
-                const char* colon = std::find(buf.peek(), crlf, ':');
-                if (colon != crlf) {
+                const char* colon =
+                    *delim == ':' ? delim : scan::findByte(delim, crlf, ':');
+                if (colon) {
                     request_.addHeader(buf.peek(), colon, crlf);
                 }
                 else {
@@ -56,16 +67,16 @@ bool HttpParser::parseRequest(Buffer& buf) {
 bool HttpParser::processRequestLine(const char* begin, const char* end) {
     bool succeed = false;
     const char* start = begin;
-    const char* space = std::find(start, end, ' ');
+    const char* space = scan::findByte(start, end, ' ');
     // Method
-    if (space != end && request_.setMethod(start, space)) {
+    if (space && request_.setMethod(start, space)) {
         start = space + 1;
-        space = std::find(start, end, ' ');
+        space = scan::findByte(start, end, ' ');
 
-        if (space != end) {
+        if (space) {
             // Path & Query
-            const char* question = std::find(start, space, '?');
-            if (question != space) {
+            const char* question = scan::findByte(start, space, '?');
+            if (question) {
                 request_.setPath(start, question);
                 request_.setQuery(question, space);
             }
@@ -81,6 +81,7 @@ public:
 
     void addHeader(const char* start, const char* colon, const char* end) {
         string field(start, colon);
+        ++colon;
         while (colon < end && isspace(*colon)) {
             ++colon;
         }
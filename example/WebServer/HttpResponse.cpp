@@ -20,11 +20,27 @@ std::unordered_map<int, std::string> HttpResponse::statusMessageMap{
     { 501, "The requested feature is not yet supported, so stay tuned" }
 };
 
-void HttpResponse::appendToBuffer(Buffer& output) const {
-    char buf[128];
-    snprintf(buf, sizeof(buf), "HTTP/1.1 %d %s", statusCode_,
-             statusTitleMap[statusCode_].c_str());
-    output.append(buf, strlen(buf));
+size_t HttpResponse::headersSizeHint() const {
+    // 状态行、Content-Length、Connection 与结尾的空行
+    size_t size = 128;
+    for (const auto& header : headers_) {
+        size += header.first.size() + header.second.size() + 4;
+    }
+    return size;
+}
+
+size_t HttpResponse::writeHeaders(char* output) const {
+    char* p = output;
+    auto append = [&p](const char* data, size_t len) {
+        memcpy(p, data, len);
+        p += len;
+    };
+    auto appendString = [&append](const string& str) {
+        append(str.data(), str.size());
+    };
+
+    p += snprintf(p, 64, "HTTP/1.1 %d %.32s\r\n", statusCode_,
+                  statusTitleMap[statusCode_].c_str());
 
     // if (!statusMessage_.empty()) {
     //     output.append(statusMessage_);
@@ -33,24 +49,33 @@ void HttpResponse::appendToBuffer(Buffer& output) const {
     //     output.append(statusMessageMap[statusCode_]);
     // }
 
-    output.append("\r\n");
-
     if (closeConnection_) {
-        output.append("Connection: close\r\n");
+        append("Connection: close\r\n", 19);
     }
     else {
-        snprintf(buf, sizeof(buf), "Content-Length: %zd\r\n", body_.size());
-        output.append(buf);
-        output.append("Connection: Keep-Alive\r\n");
+        p += snprintf(p, 48, "Content-Length: %zu\r\n", bodyLength());
+        append("Connection: Keep-Alive\r\n", 24);
     }
 
     for (const auto& header : headers_) {
-        output.append(header.first);
-        output.append(": ");
-        output.append(header.second);
-        output.append("\r\n");
+        appendString(header.first);
+        append(": ", 2);
+        appendString(header.second);
+        append("\r\n", 2);
     }
 
-    output.append("\r\n");
-    output.append(body_);
+    append("\r\n", 2);
+    return static_cast<size_t>(p - output);
+}
+
+void HttpResponse::appendHeadersToBuffer(Buffer& output) const {
+    output.ensureWritableBytes(headersSizeHint());
+    output.hasWritten(writeHeaders(output.beginWrite()));
+}
+
+void HttpResponse::appendToBuffer(Buffer& output) const {
+    appendHeadersToBuffer(output);
+    if (body_) {
+        output.append(*body_);
+    }
 }
@@ -2,6 +2,7 @@
 #define EXAMPLE_WEBSERVER_HTTPRESPONSE_H
 
 #include "core/Buffer.h"
+#include "core/BufferChain.h"
 #include "utils/copyable.h"
 #include <map>
 #include <string>
@@ -16,6 +17,7 @@ class Buffer;
 namespace webserver {
 
 using libnet::Buffer;
+using Payload = libnet::BufferChain::Payload;
 using std::map;
 using std::string;
 
@@ -36,7 +38,10 @@ public:
     static std::unordered_map<int, std::string> statusMessageMap;
 
     explicit HttpResponse(bool closeConnection)
-        : statusCode_(kUnknown), closeConnection_(closeConnection) {}
+        : statusCode_(kUnknown),
+          closeConnection_(closeConnection),
+          bodyFile_(-1),
+          bodyFileLength_(0) {}
 
     void setStatusCode(const HttpStatusCode& statusCode) {
         statusCode_ = statusCode;
@@ -51,7 +56,27 @@ public:
         closeConnection_ = closeConnection;
     }
 
-    void setBody(const string& body) { body_ = body; }
+    void setBody(const string& body) {
+        body_ = std::make_shared<const string>(body);
+    }
+    void setBody(string&& body) {
+        body_ = std::make_shared<const string>(std::move(body));
+    }
+    // 共享的 body (如缓存的文件内容) 发送时不拷贝
+    void setBody(const Payload& body) { body_ = body; }
+    const Payload& body() const { return body_; }
+
+    // 以文件作为 body，由 TcpConnection::sendFile 发送
+    // 不持有 fd，由发送方负责关闭
+    void setBodyFile(int fd, size_t length) {
+        bodyFile_       = fd;
+        bodyFileLength_ = length;
+    }
+    int    bodyFile() const { return bodyFile_; }
+    size_t bodyFileLength() const { return bodyFileLength_; }
+    size_t bodyLength() const {
+        return bodyFile_ >= 0 ? bodyFileLength_ : (body_ ? body_->size() : 0);
+    }
 
     void addHeader(const string& field, const string& value) {
         headers_[field] = value;
@@ -63,6 +88,13 @@ public:
         addHeader("Content-Type", contentType);
     }
 
+    // 状态行与 header，body 由 body() / bodyFile() 单独发送
+    // writeHeaders 直接写入调用方提供的内存 (至少 headersSizeHint() 字节)，
+    // 返回写入的字节数
+    size_t headersSizeHint() const;
+    size_t writeHeaders(char* output) const;
+    void appendHeadersToBuffer(Buffer& output) const;
+    // 不包含文件 body
     void appendToBuffer(Buffer& output) const;
 
 private:
@@ -70,7 +102,9 @@ private:
     HttpStatusCode statusCode_;
     string statusMessage_;
     bool closeConnection_;
-    string body_;
+    Payload body_;
+    int bodyFile_;
+    size_t bodyFileLength_;
 };
 
 }  // namespace webserver
@@ -13,7 +13,6 @@
 #include <fcntl.h>
 #include <functional>
 #include <string>
-#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -57,6 +56,10 @@ WebServer::WebServer(EventLoop* loop,
         std::bind(&WebServer::onConnection, this, _1));
 
     server_.setMessageCallback(std::bind(&WebServer::onMessage, this, _1, _2));
+    // keep-alive 连接大部分时间空闲，空闲时不占用缓冲区内存
+    server_.setReleaseIdleBuffers(true);
+    // 一个响应的 header 与 body 合并为一次写出
+    server_.setDeferredFlush(true);
 }
 
 void WebServer::start() {
@@ -96,12 +99,23 @@ void WebServer::onRequest(const TcpConnectionPtr& conn,
     HttpResponse response(close);
     httpCallback_(request, &response);
 
-    Buffer buffer;
-    response.appendToBuffer(buffer);
+    // header 直接序列化进连接的输出队列，不经过临时 Buffer
+    // deferredFlush 下 header 与 body 在本轮事件结束时一起写出
+    TcpConnection::OutputWriter writer =
+        conn->beginWrite(response.headersSizeHint());
+    writer.commit(response.writeHeaders(writer.data()));
 
-    conn->send(buffer);
+    if (response.bodyFile() >= 0) {
+        // 文件内容由内核直接从 page cache 发出
+        conn->sendFile(response.bodyFile(), 0, response.bodyFileLength());
+        ::close(response.bodyFile());
+    }
+    else if (response.body() && !response.body()->empty()) {
+        conn->send(response.body());
+    }
     if (close) {
-        conn->forceClose();
+        // 等待输出队列 (可能含大文件) 发送完再关闭写端
+        conn->shutdown();
     }
 }
 
@@ -135,7 +149,9 @@ void WebServer::onHttp(const HttpRequest& request, HttpResponse* response) {
     else if (path == "/favicon.ico") {
         response->setStatusCode(HttpResponse::k200Ok);
         response->setContentType("image/png");
-        response->setBody(string(favicon, sizeof(favicon)));
+        static const Payload kFavicon =
+            std::make_shared<const string>(favicon, sizeof(favicon));
+        response->setBody(kFavicon);
         return;
     }
     else if (path == "/hello") {
@@ -162,38 +178,28 @@ void WebServer::onHttp(const HttpRequest& request, HttpResponse* response) {
         return;
     }
     else {
+        response->setStatusCode(HttpResponse::k200Ok);
         response->setContentType(file_type);
         response->addHeader("Bobby's WebServer", "Based on Libnet");
     }
 
     // methid = Head done
     if (request.method() == HttpRequest::kHead) {
-        response->setStatusCode(HttpResponse::k200Ok);
-        return;
-    }
-
-    int file_fd = ::open(file_url.c_str(), O_RDONLY, 0);
-    if (file_fd < 0) {
-        response->eraseHeaders();
-        onError(response, HttpResponse::k403Forbidden);
         return;
     }
 
-    void* mmap_ret =
-        ::mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, file_fd, 0);
-    ::close(file_fd);
-    if (mmap_ret == MAP_FAILED) {
-        LOG_ERROR << "WebServer::onHttp(), mmap errno = " << errno;
+    int file_fd = ::open(file_url.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (file_fd < 0 || !S_ISREG(file_stat.st_mode)) {
+        if (file_fd >= 0) {
+            ::close(file_fd);
+        }
         response->eraseHeaders();
         onError(response, HttpResponse::k403Forbidden);
-        munmap(mmap_ret, file_stat.st_size);
         return;
     }
 
-    char* src = static_cast<char*>(mmap_ret);
-    response->setBody(std::string(src, src + file_stat.st_size));
-
-    munmap(mmap_ret, file_stat.st_size);
+    // 不再读入内存 : 由 onRequest 通过 sendfile 发送并关闭 fd
+    response->setBodyFile(file_fd, static_cast<size_t>(file_stat.st_size));
 }
 
 void WebServer::onError(HttpResponse* response,
@@ -208,7 +214,7 @@ void WebServer::onError(HttpResponse* response,
     body += "<hr><em> Bobby's Web Server</em>\n</body></html>";
 
     response->addHeader("Bobby's WebServer", "Based on Libnet");
-    response->setBody(body);
+    response->setBody(std::move(body));
 }
 
 const char favicon[555] = {
@@ -36,7 +36,8 @@ Acceptor::Acceptor(EventLoop*         loop,
       listenChannel_(std::make_unique<Channel>(loop, listenFd_)),
       listenAddr_(listenAddr),
       newConnectionCallback_(nullptr),
-      reusePort_(reusePort) {
+      reusePort_(reusePort),
+      acceptOp_(0) {
     assert(emfileFd_ > 0);
     assert(listenFd_ > 0);
     assert(loop_);
@@ -66,7 +67,12 @@ Acceptor::Acceptor(EventLoop*         loop,
 Acceptor::~Acceptor() {
     assert(listening_);
     listening_ = false;
-    listenChannel_->disableReading();
+    if (acceptOp_ != 0) {
+        loop_->poller()->abandon(acceptOp_);
+    }
+    else {
+        listenChannel_->disableReading();
+    }
     if (listenFd_) {
         ::close(listenFd_);
     }
@@ -82,6 +88,10 @@ void Acceptor::listen() {
     if (ret == -1) {
         LOG_SYSFATAL << "Acceptor::listen()";
     }
+    if (loop_->poller()->completionMode()) {
+        acceptOp_ = loop_->poller()->acceptMultishot(listenFd_, this, nullptr);
+        return;
+    }
     listenChannel_->setReadCallback([this] { this->handleRead(); });
     listenChannel_->enableReading();
 }
@@ -99,10 +109,7 @@ void Acceptor::handleRead() {
                 case EWOULDBLOCK:
                 case EINTR: continue;
                 case EMFILE:  // 当前进程打开的文件描述符已达上限
-                    ::close(emfileFd_);
-                    emfileFd_ = ::accept(listenFd_, nullptr, nullptr);
-                    ::close(emfileFd_);
-                    emfileFd_ = ::open("dev/null", O_CLOEXEC | O_RDONLY);
+                    dropConnection();
                     continue;
                 default: LOG_FATAL << "unexpected accept4() error";
             }
@@ -111,6 +118,33 @@ void Acceptor::handleRead() {
             break;
         }
     }
+    newConnection(cfd, address);
+}
+
+void Acceptor::handleAcceptComplete(int res, bool more) {
+    if (!more) {
+        acceptOp_ = 0;
+    }
+    if (res >= 0) {
+        struct sockaddr_in address = {};
+        socklen_t          len     = sizeof(address);
+        ::getpeername(res, reinterpret_cast<struct sockaddr*>(&address), &len);
+        newConnection(res, address);
+    }
+    else if (res == -EMFILE) {
+        dropConnection();
+    }
+    else if (res != -ECANCELED) {
+        errno = -res;
+        LOG_SYSERR << "Acceptor::handleAcceptComplete()";
+    }
+    // 出错后多次触发的 accept 即结束，重新提交
+    if (acceptOp_ == 0 && listening_) {
+        acceptOp_ = loop_->poller()->acceptMultishot(listenFd_, this, nullptr);
+    }
+}
+
+void Acceptor::newConnection(int cfd, const struct sockaddr_in& address) {
     if (newConnectionCallback_) {
         InetAddress peerAddr;
         peerAddr.setAddress(address);
@@ -120,3 +154,10 @@ void Acceptor::handleRead() {
         ::close(cfd);
     }
 }
+
+void Acceptor::dropConnection() {
+    ::close(emfileFd_);
+    emfileFd_ = ::accept(listenFd_, nullptr, nullptr);
+    ::close(emfileFd_);
+    emfileFd_ = ::open("/dev/null", O_CLOEXEC | O_RDONLY);
+}
@@ -4,6 +4,7 @@
 #include "core/Callbacks.h"
 #include "core/Channel.h"
 #include "core/InetAddress.h"
+#include "core/Poller.h"
 #include "utils/noncopyable.h"
 #include <algorithm>
 #include <memory>
@@ -12,7 +13,8 @@ namespace libnet {
 
 class EventLoop;
 
-class Acceptor : noncopyable
+// Poller 支持完成模式时以多次触发的 accept 接受连接，不再注册可读事件
+class Acceptor : noncopyable, private Poller::CompletionHandler
 {
 public:
     using ptr = std::unique_ptr<Acceptor>;
@@ -33,6 +35,10 @@ public:
 
 private:
     void handleRead();
+    void handleAcceptComplete(int res, bool more) override;
+    void newConnection(int cfd, const struct sockaddr_in& address);
+    // 文件描述符耗尽时用预留的 fd 接受并立即关闭一个连接，避免一直就绪
+    void dropConnection();
 
     bool                     listening_;
     int                      listenFd_;
@@ -42,6 +48,7 @@ private:
     InetAddress              listenAddr_;
     NewConnectionCallback    newConnectionCallback_;
     bool                     reusePort_;
+    Poller::OpId             acceptOp_;  // 完成模式下在途的 accept
 };
 
 }  // namespace libnet
@@ -1,26 +1,82 @@
 #include "core/Buffer.h"
 #include <cerrno>
 #include <sys/uio.h>
+#include <unistd.h>
 
 using namespace libnet;
 
-const char   Buffer::kCRLF[] = "\r\n";
+char         Buffer::kEmpty[Buffer::kCheapPrepend];
 const size_t Buffer::kCheapPrepend;
 const size_t Buffer::kInitialSize;
 
+void Buffer::makeSpace(size_t len) {
+    if (writableBytes() + prependableBytes() < len + kCheapPrepend) {
+        // 申请更大的 block 并把可读数据搬到新 block 的头部
+        size_t readable = readableBytes();
+        size_t size     = std::max(kCheapPrepend + readable + len,
+                                   storage_.data ? 2 * storage_.size
+                                                 : kCheapPrepend + initialSize_);
+        BufferPool::Block storage =
+            pool_ ? pool_->allocate(size) : BufferPool::heapAllocate(size);
+        std::copy(peek(), peek() + readable, storage.data + kCheapPrepend);
+        deallocate();
+        storage_     = storage;
+        readerIndex_ = kCheapPrepend;
+        writerIndex_ = readerIndex_ + readable;
+    }
+    else {
+        assert(kCheapPrepend < readerIndex_);
+        size_t readable = readableBytes();
+        std::copy(begin() + readerIndex_, begin() + writerIndex_,
+                  begin() + kCheapPrepend);
+        readerIndex_ = kCheapPrepend;
+        writerIndex_ = readerIndex_ + readable;
+        assert(readable == readableBytes());
+    }
+}
+
 ssize_t Buffer::readFd(int fd, int* savedErrno) {
-    char         extrabuf[65535];
+    if (pool_ && pool_->isOwnerThread()) {
+        if (storage_.data == nullptr) {
+            // 连接暂时借用 loop 的 scratch，不为空闲连接预先分配内存
+            storage_.data = pool_->scratch();
+            storage_.size = BufferPool::kScratchSize;
+            borrowed_     = true;
+            retrieveAll();
+
+            const ssize_t n = ::read(fd, beginWrite(), writableBytes());
+            if (n < 0) {
+                *savedErrno = errno;
+            }
+            else {
+                writerIndex_ += n;
+            }
+            return n;
+        }
+        if (!borrowed_) {
+            return readFd(fd, pool_->scratch(), BufferPool::kScratchSize,
+                          savedErrno);
+        }
+    }
+    char extrabuf[65536];
+    return readFd(fd, extrabuf, sizeof(extrabuf), savedErrno);
+}
+
+ssize_t Buffer::readFd(int    fd,
+                       char*  extrabuf,
+                       size_t extralen,
+                       int*   savedErrno) {
     struct iovec vec[2];
     const size_t writable = writableBytes();
 
-    vec[0].iov_base = begin() + writerIndex_;
+    vec[0].iov_base = beginWrite();
     vec[0].iov_len  = writable;
     vec[1].iov_base = extrabuf;
-    vec[1].iov_len  = sizeof(extrabuf);
+    vec[1].iov_len  = extralen;
 
     // when there is enough space in this buffer, don't read into extrabuf.
     // when extrabuf is used, we read 128k-1 bytes at most.
-    const int     iovcnt = (writable < sizeof(extrabuf) ? 2 : 1);
+    const int     iovcnt = (writable < extralen ? 2 : 1);
     const ssize_t n      = ::readv(fd, vec, iovcnt);
 
     if (n < 0) {
@@ -30,8 +86,43 @@ ssize_t Buffer::readFd(int fd, int* savedErrno) {
         writerIndex_ += n;
     }
     else {
-        writerIndex_ = buffer_.size();
+        writerIndex_ += writable;
         append(extrabuf, n - writable);
     }
     return n;
 }
+
+void Buffer::receive(char* block, size_t size, size_t len) {
+    assert(kCheapPrepend + len <= size);
+    if (storage_.data == nullptr && pool_) {
+        storage_.data = block;
+        storage_.size = size;
+        borrowed_     = true;
+        retrieveAll();
+        writerIndex_ += len;
+    }
+    else {
+        append(block + kCheapPrepend, len);
+    }
+}
+
+void Buffer::detachScratch() {
+    if (!borrowed_) {
+        return;
+    }
+    size_t readable = readableBytes();
+    if (readable == 0) {
+        deallocate();
+        retrieveAll();
+        return;
+    }
+    // 剩余不完整的消息才需要自己的存储
+    size_t size =
+        std::max(kCheapPrepend + readable, kCheapPrepend + initialSize_);
+    BufferPool::Block storage = pool_->allocate(size);
+    std::copy(peek(), peek() + readable, storage.data + kCheapPrepend);
+    deallocate();
+    storage_     = storage;
+    readerIndex_ = kCheapPrepend;
+    writerIndex_ = readerIndex_ + readable;
+}
@@ -1,12 +1,14 @@
 #ifndef LIBNET_BUFFER_H
 #define LIBNET_BUFFER_H
 
+#include "core/BufferPool.h"
+#include "core/ByteScan.h"
+
 #include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <endian.h>
 #include <string>
-#include <vector>
 
 namespace libnet {
 
@@ -17,20 +19,53 @@ public:
     static const size_t kInitialSize  = 1024;
 
     explicit Buffer(size_t initialSize = kInitialSize)
-        : buffer_(kCheapPrepend + initialSize),
-          readerIndex_(kCheapPrepend),
-          writerIndex_(kCheapPrepend) {
+        : Buffer(nullptr, initialSize) {
+        // 不使用内存池的 Buffer 立即分配存储
+        allocate(kCheapPrepend + initialSize);
         assert(readableBytes() == 0);
         assert(writableBytes() == initialSize);
         assert(prependableBytes() == kCheapPrepend);
     }
 
+    // 从 loop 的内存池借用存储 : 直到第一次写入才分配，
+    // 这样在其他线程构造的 Buffer 也只会在所属 loop 线程中访问内存池
+    Buffer(BufferPool::ptr pool, size_t initialSize)
+        : pool_(std::move(pool)),
+          initialSize_(initialSize),
+          borrowed_(false),
+          readerIndex_(kCheapPrepend),
+          writerIndex_(kCheapPrepend) {}
+
+    explicit Buffer(BufferPool::ptr pool)
+        : Buffer(std::move(pool), kInitialSize) {}
+
+    Buffer(const Buffer& rhs) : Buffer(rhs.readableBytes()) {
+        append(rhs.peek(), rhs.readableBytes());
+    }
+
+    Buffer(Buffer&& rhs) noexcept : Buffer(nullptr, rhs.initialSize_) {
+        swap(rhs);
+    }
+
+    Buffer& operator=(Buffer rhs) {
+        swap(rhs);
+        return *this;
+    }
+
+    ~Buffer() { deallocate(); }
+
     size_t readableBytes() const { return writerIndex_ - readerIndex_; }
-    size_t writableBytes() const { return buffer_.size() - writerIndex_; }
+    size_t writableBytes() const {
+        return storage_.data ? storage_.size - writerIndex_ : 0;
+    }
+    size_t capacity() const { return storage_.size; }
     size_t prependableBytes() const { return readerIndex_; }
 
     void swap(Buffer& rhs) {
-        buffer_.swap(rhs.buffer_);
+        std::swap(pool_, rhs.pool_);
+        std::swap(storage_, rhs.storage_);
+        std::swap(initialSize_, rhs.initialSize_);
+        std::swap(borrowed_, rhs.borrowed_);
         std::swap(readerIndex_, rhs.readerIndex_);
         std::swap(writerIndex_, rhs.writerIndex_);
     }
@@ -57,20 +92,20 @@ public:
     const char* findCRLF(const char* start) const {
         assert(peek() <= start);
         assert(start <= beginWrite());
-        const char* crlf = std::search(peek(), beginWrite(), kCRLF, kCRLF + 2);
-        return crlf == beginWrite() ? nullptr : crlf;
+        return scan::findCRLF(start, beginWrite());
     }
 
-    const char* findEOL() const {
-        const void* eol = memchr(peek(), '\n', readableBytes());
-        return static_cast<const char*>(eol);
+    // 查找头部结束标志 "\r\n\r\n"
+    const char* findCRLFCRLF() const {
+        return scan::findCRLFCRLF(peek(), beginWrite());
     }
 
+    const char* findEOL() const { return findEOL(peek()); }
+
     const char* findEOL(const char* start) const {
         assert(peek() <= start);
         assert(start <= beginWrite());
-        const void* eol = memchr(start, '\n', beginWrite() - start);
-        return static_cast<const char*>(eol);
+        return scan::findByte(start, beginWrite(), '\n');
     }
 
     // retrieve : 移动 index，相当于移除数据
@@ -143,6 +178,9 @@ public:
 
     // prepend : 将 data 插入前置空间
     void prepend(const void* data, size_t len) {
+        if (storage_.data == nullptr) {
+            allocate(kCheapPrepend + initialSize_);
+        }
         assert(len <= prependableBytes());
         readerIndex_ -= len;
         auto d = static_cast<const char*>(data);
@@ -156,27 +194,60 @@ public:
         prepend(&be, sizeof(be));
     }
 
+    // 没有自己的存储时，直接读入 loop 共享的 scratch 区域并暂时借用它；
+    // 调用者处理完数据后必须立即调用 detachScratch()
     ssize_t readFd(int fd, int* savedErrno);
 
+    // 收下完成模式中 Poller 读入的数据 : 数据在 block + kCheapPrepend 处，
+    // 共 len 字节，block 共 size 字节。没有自己的存储时与 readFd 一样暂时借用
+    // block，调用者处理完数据后必须立即调用 detachScratch()
+    void receive(char* block, size_t size, size_t len);
+
+    // 归还借用的 scratch : 还有剩余数据 (不完整的消息) 时才分配自己的存储
+    void detachScratch();
+
+    // 缓冲区为空时把存储还给内存池，空闲连接因此不占用 Buffer 内存
+    void releaseIfEmpty() {
+        if (readableBytes() == 0 && storage_.data != nullptr) {
+            deallocate();
+            retrieveAll();
+        }
+    }
+
+    bool hasStorage() const { return storage_.data != nullptr; }
+    // 存储来自某个 loop 的内存池 (或借用其 scratch)，只能在该 loop 线程中使用
+    bool usesPool() const { return pool_ != nullptr; }
+
 private:
-    char*       begin() { return &*buffer_.begin(); }
-    const char* begin() const { return &*buffer_.begin(); }
+    // 尚未分配存储时指向一块静态的空区域，保证 peek() 等始终有效
+    char*       begin() { return storage_.data ? storage_.data : kEmpty; }
+    const char* begin() const {
+        return storage_.data ? storage_.data : kEmpty;
+    }
+
+    void allocate(size_t size) {
+        assert(storage_.data == nullptr);
+        storage_ = pool_ ? pool_->allocate(size)
+                         : BufferPool::heapAllocate(size);
+    }
 
-    void makeSpace(size_t len) {
-        if (writableBytes() + prependableBytes() < len + kCheapPrepend) {
-            buffer_.resize(writerIndex_ + len);
+    void deallocate() {
+        if (borrowed_) {
+            borrowed_ = false;
         }
-        else {
-            assert(kCheapPrepend < readerIndex_);
-            size_t readable = readableBytes();
-            std::copy(begin() + readerIndex_, begin() + writerIndex_,
-                      begin() + kCheapPrepend);
-            readerIndex_ = kCheapPrepend;
-            writerIndex_ = readerIndex_ + readable;
-            assert(readable == readableBytes());
+        else if (pool_) {
+            pool_->deallocate(storage_);
         }
+        else if (storage_.data) {
+            BufferPool::heapDeallocate(storage_);
+        }
+        storage_ = BufferPool::Block();
     }
 
+    void makeSpace(size_t len);
+
+    ssize_t readFd(int fd, char* extrabuf, size_t extralen, int* savedErrno);
+
     template <typename T> T htobe(T value) const {
         if constexpr (sizeof(T) == 1) {
             return value;
@@ -217,11 +288,14 @@ private:
         }
     }
 
-    std::vector<char> buffer_;
+    BufferPool::ptr   pool_;
+    BufferPool::Block storage_;
+    size_t            initialSize_;
+    bool              borrowed_;  // storage_ 为 pool 的 scratch
     size_t            readerIndex_;
     size_t            writerIndex_;
 
-    static const char kCRLF[];
+    static char       kEmpty[kCheapPrepend];
 };
 
 }  // namespace libnet
@@ -0,0 +1,338 @@
+#include "core/BufferChain.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#ifndef MSG_ZEROCOPY
+#    define MSG_ZEROCOPY 0x4000000
+#endif
+
+using namespace libnet;
+
+const size_t BufferChain::kBlockSize;
+const size_t BufferChain::kReadSize;
+const size_t BufferChain::kMinReferenceSize;
+
+BufferChain::BufferChain(BufferPool::ptr pool)
+    : pool_(std::move(pool)),
+      readable_(0),
+      zeroCopyThreshold_(0),
+      zeroCopySeq_(0),
+      zeroCopySends_(0),
+      writeCalls_(0) {}
+
+BufferChain::~BufferChain() {
+    while (!blocks_.empty()) {
+        popBack();
+    }
+}
+
+void BufferChain::pushBlock(size_t size) {
+    blocks_.emplace_back(pool_ ? pool_->allocate(size)
+                               : BufferPool::heapAllocate(size));
+}
+
+void BufferChain::release(const Block& block) {
+    if (!block.owned()) {
+        return;  // 外部数据由 holder 析构释放
+    }
+    if (pool_) {
+        pool_->deallocate(block.storage);
+    }
+    else {
+        BufferPool::heapDeallocate(block.storage);
+    }
+}
+
+void BufferChain::popFront() {
+    release(blocks_.front());
+    blocks_.pop_front();
+}
+
+void BufferChain::popBack() {
+    release(blocks_.back());
+    blocks_.pop_back();
+}
+
+void BufferChain::retrieve(size_t len) {
+    assert(len <= readableBytes());
+    readable_ -= len;
+    while (len > 0) {
+        Block& front = blocks_.front();
+        size_t n     = std::min(len, front.readableBytes());
+        front.readIndex += n;
+        len -= n;
+        if (front.readableBytes() == 0) {
+            if (blocks_.size() > 1 || !front.owned()) {
+                popFront();
+            }
+            else {
+                // 保留最后一个 block 以供后续 append 复用
+                front.readIndex  = 0;
+                front.writeIndex = 0;
+            }
+        }
+    }
+    dropEmptyFront();
+}
+
+void BufferChain::dropEmptyFront() {
+    // retrieve 保留的空 block 之后又挂上了外部或文件 block 时，它会留在链首
+    while (blocks_.size() > 1 && blocks_.front().readableBytes() == 0) {
+        popFront();
+    }
+}
+
+void BufferChain::retrieveAll() {
+    retrieve(readableBytes());
+}
+
+void BufferChain::releaseIfEmpty() {
+    if (empty()) {
+        while (!blocks_.empty()) {
+            popBack();
+        }
+    }
+}
+
+std::string BufferChain::retrieveAsString(size_t len) {
+    assert(len <= readableBytes());
+    std::string result;
+    result.reserve(len);
+    size_t remain = len;
+    for (const Block& block : blocks_) {
+        if (remain == 0) {
+            break;
+        }
+        assert(!block.isFile());
+        size_t n = std::min(remain, block.readableBytes());
+        result.append(block.data() + block.readIndex, n);
+        remain -= n;
+    }
+    retrieve(len);
+    return result;
+}
+
+void BufferChain::append(const char* data, size_t len) {
+    readable_ += len;
+    while (len > 0) {
+        if (tailWritableBytes() == 0) {
+            pushBlock();
+        }
+        Block& tail = blocks_.back();
+        size_t n    = std::min(len, tail.writableBytes());
+        std::copy(data, data + n, tail.data() + tail.writeIndex);
+        tail.writeIndex += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void BufferChain::append(const char*                 data,
+                         size_t                      len,
+                         std::shared_ptr<const void> holder) {
+    if (len < kMinReferenceSize) {
+        append(data, len);
+        return;
+    }
+    readable_ += len;
+    blocks_.emplace_back(data, len, std::move(holder));
+}
+
+void BufferChain::append(std::string&& data, size_t offset) {
+    assert(offset <= data.size());
+    const size_t len = data.size() - offset;
+    if (len < kMinReferenceSize) {
+        append(data.data() + offset, len);
+        return;
+    }
+    auto owner = std::make_shared<const std::string>(std::move(data));
+    append(owner->data() + offset, len, owner);
+}
+
+char* BufferChain::beginWrite(size_t len) {
+    if (tailWritableBytes() < len) {
+        pushBlock(std::max(len, kBlockSize));
+    }
+    Block& tail = blocks_.back();
+    return tail.data() + tail.writeIndex;
+}
+
+void BufferChain::hasWritten(size_t len) {
+    assert(len <= tailWritableBytes());
+    if (len > 0) {
+        blocks_.back().writeIndex += len;
+        readable_ += len;
+    }
+}
+
+void BufferChain::appendFile(int                         fd,
+                             off_t                       offset,
+                             size_t                      len,
+                             std::shared_ptr<const void> holder) {
+    if (len == 0) {
+        return;
+    }
+    readable_ += len;
+    blocks_.emplace_back(fd, offset, len, std::move(holder));
+}
+
+int BufferChain::readableIovec(struct iovec* iov, int maxIov) const {
+    int count = 0;
+    for (const Block& block : blocks_) {
+        if (count == maxIov || block.isFile() || zeroCopyEligible(block)) {
+            break;
+        }
+        if (block.readableBytes() == 0) {
+            continue;
+        }
+        iov[count].iov_base = block.data() + block.readIndex;
+        iov[count].iov_len  = block.readableBytes();
+        ++count;
+    }
+    return count;
+}
+
+ssize_t BufferChain::readFd(int fd, int* savedErrno) {
+    const size_t kMaxReadIov = kReadSize / kBlockSize + 1;
+    struct iovec vec[kMaxReadIov];
+    int          iovcnt   = 0;
+    size_t       writable = tailWritableBytes();
+    const size_t tailIdx  = blocks_.size();  // 新 block 的起始下标
+
+    if (writable > 0) {
+        Block& tail          = blocks_.back();
+        vec[iovcnt].iov_base = tail.data() + tail.writeIndex;
+        vec[iovcnt].iov_len  = writable;
+        ++iovcnt;
+    }
+    // readv 直接读入新的 block，而不是栈上的 extrabuf
+    while (writable < kReadSize) {
+        pushBlock();
+        vec[iovcnt].iov_base = blocks_.back().data();
+        vec[iovcnt].iov_len  = kBlockSize;
+        writable += kBlockSize;
+        ++iovcnt;
+    }
+
+    const ssize_t n = ::readv(fd, vec, iovcnt);
+    if (n < 0) {
+        *savedErrno = errno;
+    }
+
+    size_t remain = n > 0 ? static_cast<size_t>(n) : 0;
+    readable_ += remain;
+    size_t idx = tailIdx > 0 ? tailIdx - 1 : 0;
+    for (; idx < blocks_.size() && remain > 0; ++idx) {
+        Block& block = blocks_[idx];
+        size_t len   = std::min(remain, block.writableBytes());
+        block.writeIndex += len;
+        remain -= len;
+    }
+    // 释放没有用到的新 block
+    while (blocks_.size() > std::max<size_t>(tailIdx, 1) &&
+           blocks_.back().writeIndex == 0) {
+        popBack();
+    }
+    return n;
+}
+
+ssize_t BufferChain::writeFd(int fd, int* savedErrno) {
+    ssize_t total = 0;
+    while (!empty()) {
+        dropEmptyFront();
+        ssize_t n       = 0;
+        size_t  request = 0;
+        if (blocks_.front().isFile()) {
+            request = blocks_.front().readableBytes();
+            n       = writeFileFd(fd, savedErrno);
+        }
+        else if (zeroCopyEligible(blocks_.front())) {
+            request = blocks_.front().readableBytes();
+            n       = writeZeroCopy(fd, savedErrno);
+        }
+        else {
+            struct iovec vec[IOV_MAX];
+            int          iovcnt = readableIovec(vec, IOV_MAX);
+            assert(iovcnt > 0);
+            for (int i = 0; i < iovcnt; ++i) {
+                request += vec[i].iov_len;
+            }
+            n = ::writev(fd, vec, iovcnt);
+            ++writeCalls_;
+            if (n < 0) {
+                *savedErrno = errno;
+            }
+            else {
+                retrieve(static_cast<size_t>(n));
+            }
+        }
+        if (n < 0) {
+            // 已经写出过数据时，错误留给下一次写处理
+            return total > 0 ? total : n;
+        }
+        total += n;
+        if (static_cast<size_t>(n) < request) {
+            break;  // 发送缓冲区已满
+        }
+    }
+    return total;
+}
+
+ssize_t BufferChain::writeFileFd(int fd, int* savedErrno) {
+    Block&  block  = blocks_.front();
+    off_t   offset = block.fileOffset + static_cast<off_t>(block.readIndex);
+    ssize_t n      = ::sendfile(fd, block.fd, &offset, block.readableBytes());
+    ++writeCalls_;
+    if (n < 0) {
+        *savedErrno = errno;
+    }
+    else if (n == 0) {
+        // 文件在发送期间被截断，剩余部分永远无法发出
+        *savedErrno = EIO;
+        n           = -1;
+    }
+    else {
+        retrieve(static_cast<size_t>(n));
+    }
+    return n;
+}
+
+ssize_t BufferChain::writeZeroCopy(int fd, int* savedErrno) {
+    Block&      block = blocks_.front();
+    const char* data  = block.data() + block.readIndex;
+    ssize_t     n     = ::send(fd, data, block.readableBytes(), MSG_ZEROCOPY);
+    ++writeCalls_;
+    if (n < 0 && errno == ENOBUFS) {
+        // 超出 optmem 限制，这一次退回普通拷贝
+        n = ::send(fd, data, block.readableBytes(), 0);
+        ++writeCalls_;
+        if (n < 0) {
+            *savedErrno = errno;
+        }
+        else {
+            retrieve(static_cast<size_t>(n));
+        }
+        return n;
+    }
+    if (n < 0) {
+        *savedErrno = errno;
+        return n;
+    }
+    // 内核引用了这段内存，retrieve 之后 holder 仍需保留
+    pinned_.push_back({ zeroCopySeq_++, block.holder });
+    ++zeroCopySends_;
+    retrieve(static_cast<size_t>(n));
+    return n;
+}
+
+void BufferChain::releasePinned(PinnedQueue& pinned, uint32_t hi) {
+    while (!pinned.empty() &&
+           static_cast<int32_t>(pinned.front().seq - hi) <= 0) {
+        pinned.pop_front();
+    }
+}
@@ -0,0 +1,203 @@
+#ifndef LIBNET_BUFFERCHAIN_H
+#define LIBNET_BUFFERCHAIN_H
+
+#include "core/BufferPool.h"
+#include "utils/RingQueue.h"
+#include "utils/noncopyable.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace libnet {
+
+// 分段缓冲区 : 由定长 block 串成的链表
+// 追加数据只会申请新的 block，从不 realloc，也从不 memmove 已有数据
+// 读写 fd 时直接 readv/writev 整条链
+// block 从所属 loop 的 BufferPool 借用，没有 pool 时从堆上分配
+// 除自有 block 外，链中还可以挂接外部数据 (移入的 std::string、共享的只读
+// payload)，这类 block 只保存引用并持有其所有者，写出时与其他 block 一起 writev
+// 文件区段同样可以排在链中，写到它时改用 sendfile，数据不经过用户态
+// 开启零拷贝后，较大的外部 block 以 MSG_ZEROCOPY 发送，其 holder 一直保留到
+// 内核发出完成通知
+class BufferChain : noncopyable
+{
+public:
+    // 不可变的共享数据，如缓存的文件内容，可同时挂在多个连接的输出链上
+    using Payload = std::shared_ptr<const std::string>;
+
+    static const size_t kBlockSize = 16 * 1024;
+    static const size_t kReadSize  = 64 * 1024;
+    // 小于该长度的外部数据直接拷贝，不值得单独占用一个 iovec
+    static const size_t kMinReferenceSize = 512;
+
+    explicit BufferChain(BufferPool::ptr pool = nullptr);
+    ~BufferChain();
+
+    size_t readableBytes() const { return readable_; }
+    bool   empty() const { return readable_ == 0; }
+    size_t numBlocks() const { return blocks_.size(); }
+
+    // 第一个 block 中连续可读的数据，不能是文件区段
+    const char* peek() const {
+        assert(!empty() && !blocks_.front().isFile());
+        return blocks_.front().data() + blocks_.front().readIndex;
+    }
+    size_t peekableBytes() const {
+        return empty() ? 0 : blocks_.front().readableBytes();
+    }
+
+    void retrieve(size_t len);
+    void retrieveAll();
+
+    // 链为空时释放保留的 block
+    void releaseIfEmpty();
+
+    std::string retrieveAsString(size_t len);
+    std::string retrieveAllAsString() {
+        return retrieveAsString(readableBytes());
+    }
+
+    void append(const char* data, size_t len);
+    void append(const std::string& data) {
+        append(data.data(), data.size());
+    }
+    void append(const void* data, size_t len) {
+        append(static_cast<const char*>(data), len);
+    }
+
+    // 引用 [data, data+len)，holder 保证数据在写出前有效
+    void append(const char* data, size_t len, std::shared_ptr<const void> holder);
+    // 接管 data 中从 offset 开始的内容，不拷贝
+    void append(std::string&& data, size_t offset = 0);
+    void append(const Payload& payload, size_t offset = 0) {
+        append(payload->data() + offset, payload->size() - offset, payload);
+    }
+    // 尾部至少 len 字节的连续可写空间，直接写入后调用 hasWritten 提交
+    char* beginWrite(size_t len);
+    void  hasWritten(size_t len);
+
+    // 文件 fd 中 [offset, offset+len) 的内容，holder 保证 fd 在写出前不被关闭
+    void appendFile(int fd, off_t offset, size_t len,
+                    std::shared_ptr<const void> holder);
+
+    // threshold 为 0 时关闭；fd 需已设置 SO_ZEROCOPY
+    void   setZeroCopyThreshold(size_t threshold) {
+        zeroCopyThreshold_ = threshold;
+    }
+    size_t zeroCopyThreshold() const { return zeroCopyThreshold_; }
+    // 已交给内核、等待完成通知的数据
+    struct Pinned
+    {
+        uint32_t                    seq;
+        std::shared_ptr<const void> holder;
+    };
+    using PinnedQueue = std::deque<Pinned>;
+
+    // 序号不超过 hi 的零拷贝发送已完成，释放其固定的数据 (TCP 的通知按序到达)
+    void     releaseZeroCopy(uint32_t hi) { releasePinned(pinned_, hi); }
+    static void releasePinned(PinnedQueue& pinned, uint32_t hi);
+    // 取走尚未完成的零拷贝数据，由调用者保留到完成通知到达
+    PinnedQueue takePinned() {
+        PinnedQueue pinned;
+        pinned.swap(pinned_);
+        return pinned;
+    }
+    size_t   pinnedCount() const { return pinned_.size(); }
+    uint64_t zeroCopySends() const { return zeroCopySends_; }
+    // writeFd 累计发起的系统调用次数
+    uint64_t writeCalls() const { return writeCalls_; }
+
+    // iovec 视图 : 按顺序填充至多 maxIov 个可读片段，返回填充的个数
+    // 遇到文件区段或需要零拷贝发送的 block 即停止
+    int readableIovec(struct iovec* iov, int maxIov) const;
+
+    ssize_t readFd(int fd, int* savedErrno);
+    // 依次 writev 内存片段、sendfile 文件区段，直到写完或 fd 不再可写
+    ssize_t writeFd(int fd, int* savedErrno);
+
+private:
+    struct Block
+    {
+        explicit Block(const BufferPool::Block& block)
+            : storage(block),
+              base(block.data),
+              capacity(block.size),
+              readIndex(0),
+              writeIndex(0),
+              fd(-1),
+              fileOffset(0) {}
+
+        // 外部数据 : 只读，writableBytes() 恒为 0
+        Block(const char* data, size_t len, std::shared_ptr<const void> owner)
+            : holder(std::move(owner)),
+              base(const_cast<char*>(data)),
+              capacity(len),
+              readIndex(0),
+              writeIndex(len),
+              fd(-1),
+              fileOffset(0) {}
+
+        // 文件区段 : 没有内存，data() 为空
+        Block(int file, off_t offset, size_t len,
+              std::shared_ptr<const void> owner)
+            : holder(std::move(owner)),
+              base(nullptr),
+              capacity(len),
+              readIndex(0),
+              writeIndex(len),
+              fd(file),
+              fileOffset(offset) {}
+
+        char*  data() const { return base; }
+        bool   owned() const { return storage.data != nullptr; }
+        bool   isFile() const { return fd >= 0; }
+        size_t readableBytes() const { return writeIndex - readIndex; }
+        size_t writableBytes() const { return capacity - writeIndex; }
+
+        BufferPool::Block           storage;  // 自有存储
+        std::shared_ptr<const void> holder;   // 外部数据的所有者
+        char*                       base;
+        size_t                      capacity;
+        size_t                      readIndex;
+        size_t                      writeIndex;
+        int                         fd;
+        off_t                       fileOffset;
+    };
+
+    void release(const Block& block);
+    bool zeroCopyEligible(const Block& block) const {
+        return zeroCopyThreshold_ > 0 && block.holder && !block.isFile() &&
+               block.readableBytes() >= zeroCopyThreshold_;
+    }
+    ssize_t writeFileFd(int fd, int* savedErrno);
+    ssize_t writeZeroCopy(int fd, int* savedErrno);
+
+    void pushBlock(size_t size = kBlockSize);
+    void popFront();
+    // 弹出链首没有数据的 block (至少留一个复用)，链非空时链首总有可读数据
+    void dropEmptyFront();
+    void popBack();
+
+    size_t tailWritableBytes() const {
+        return blocks_.empty() ? 0 : blocks_.back().writableBytes();
+    }
+
+    BufferPool::ptr    pool_;
+    RingQueue<Block>   blocks_;  // 复用槽位，收发稳定后不再分配内存
+    size_t             readable_;
+    size_t             zeroCopyThreshold_;
+    uint32_t           zeroCopySeq_;  // 与内核中该 socket 的通知序号一致
+    uint64_t           zeroCopySends_;
+    uint64_t           writeCalls_;
+    PinnedQueue        pinned_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_BUFFERCHAIN_H
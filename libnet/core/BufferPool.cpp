@@ -0,0 +1,168 @@
+#include "core/BufferPool.h"
+#include "logger/Logger.h"
+
+#include <cassert>
+#include <sys/mman.h>
+
+using namespace libnet;
+
+const size_t BufferPool::kNumClasses;
+const size_t BufferPool::kMinBlockSize;
+const size_t BufferPool::kMaxBlockSize;
+const size_t BufferPool::kSlabSize;
+const size_t BufferPool::kScratchSize;
+
+BufferPool::BufferPool(bool useHugePages)
+    : owner_(std::this_thread::get_id()),
+      useHugePages_(useHugePages),
+      slabCur_(nullptr),
+      slabEnd_(nullptr),
+      scratch_(nullptr),
+      hits_(0),
+      misses_(0),
+      heapAllocs_(0),
+      remoteFrees_(0),
+      slabBytes_(0),
+      inUseBytes_(0) {
+    for (size_t i = 0; i < kNumClasses; ++i) {
+        freeList_[i] = nullptr;
+        remoteFreeList_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+BufferPool::~BufferPool() {
+    for (const Slab& slab : slabs_) {
+        ::munmap(slab.base, slab.size);
+    }
+}
+
+int BufferPool::sizeClass(size_t size) {
+    int cls = 0;
+    while (cls < static_cast<int>(kNumClasses) && classSize(cls) < size) {
+        ++cls;
+    }
+    return cls < static_cast<int>(kNumClasses) ? cls : -1;
+}
+
+BufferPool::Block BufferPool::allocate(size_t size) {
+    int cls = sizeClass(size);
+    if (cls < 0 || !isOwnerThread()) {
+        heapAllocs_.fetch_add(1, std::memory_order_relaxed);
+        Block block = heapAllocate(size);
+        inUseBytes_.fetch_add(block.size, std::memory_order_relaxed);
+        return block;
+    }
+
+    FreeNode* node = freeList_[cls];
+    if (node == nullptr) {
+        // 收回其他线程归还的 block
+        node = remoteFreeList_[cls].exchange(nullptr, std::memory_order_acquire);
+    }
+
+    Block block;
+    block.size   = classSize(cls);
+    block.pooled = true;
+    if (node != nullptr) {
+        freeList_[cls] = node->next;
+        block.data     = reinterpret_cast<char*>(node);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        block.data = carve(block.size);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+    }
+    inUseBytes_.fetch_add(block.size, std::memory_order_relaxed);
+    return block;
+}
+
+void BufferPool::deallocate(const Block& block) {
+    if (block.data == nullptr) {
+        return;
+    }
+    inUseBytes_.fetch_sub(block.size, std::memory_order_relaxed);
+    if (!block.pooled) {
+        heapDeallocate(block);
+        return;
+    }
+
+    int cls = sizeClass(block.size);
+    assert(cls >= 0 && classSize(cls) == block.size);
+    FreeNode* node = reinterpret_cast<FreeNode*>(block.data);
+    if (isOwnerThread()) {
+        node->next     = freeList_[cls];
+        freeList_[cls] = node;
+    }
+    else {
+        // 只有 push 与整体 exchange 两种操作，不存在 ABA 问题
+        FreeNode* head = remoteFreeList_[cls].load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!remoteFreeList_[cls].compare_exchange_weak(
+            head, node, std::memory_order_release, std::memory_order_relaxed));
+        remoteFrees_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+BufferPool::Block BufferPool::heapAllocate(size_t size) {
+    Block block;
+    block.data   = new char[size];
+    block.size   = size;
+    block.pooled = false;
+    return block;
+}
+
+void BufferPool::heapDeallocate(const Block& block) {
+    assert(!block.pooled);
+    delete[] block.data;
+}
+
+char* BufferPool::scratch() {
+    assert(isOwnerThread());
+    if (scratch_ == nullptr) {
+        scratch_ = carve(kScratchSize);
+    }
+    return scratch_;
+}
+
+BufferPool::Stats BufferPool::stats() const {
+    Stats stats;
+    stats.hits        = hits_.load(std::memory_order_relaxed);
+    stats.misses      = misses_.load(std::memory_order_relaxed);
+    stats.heapAllocs  = heapAllocs_.load(std::memory_order_relaxed);
+    stats.remoteFrees = remoteFrees_.load(std::memory_order_relaxed);
+    stats.slabBytes   = slabBytes_.load(std::memory_order_relaxed);
+    stats.inUseBytes  = inUseBytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+char* BufferPool::carve(size_t size) {
+    if (static_cast<size_t>(slabEnd_ - slabCur_) < size) {
+        newSlab();
+    }
+    char* data = slabCur_;
+    slabCur_ += size;
+    return data;
+}
+
+void BufferPool::newSlab() {
+    void* base = MAP_FAILED;
+    if (useHugePages_) {
+        base = ::mmap(nullptr, kSlabSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+    if (base == MAP_FAILED) {
+        base = ::mmap(nullptr, kSlabSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            LOG_SYSFATAL << "BufferPool::newSlab() mmap";
+        }
+        // 没有预留的 hugetlb 页时，退而使用透明大页
+        if (useHugePages_) {
+            ::madvise(base, kSlabSize, MADV_HUGEPAGE);
+        }
+    }
+    slabs_.push_back({ static_cast<char*>(base), kSlabSize });
+    slabCur_ = static_cast<char*>(base);
+    slabEnd_ = slabCur_ + kSlabSize;
+    slabBytes_.fetch_add(kSlabSize, std::memory_order_relaxed);
+}
@@ -0,0 +1,109 @@
+#ifndef LIBNET_BUFFERPOOL_H
+#define LIBNET_BUFFERPOOL_H
+
+#include "utils/noncopyable.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace libnet {
+
+// 每个 EventLoop 一个的 slab 内存池，为 Buffer / BufferChain 提供存储
+// 按 1K/4K/16K/64K 四个尺寸分级，每级一条空闲链表
+// 只有所属的 loop 线程可以从池中分配，因此分配与归还都不需要加锁；
+// 其他线程归还的 block 先挂到无锁的 remote 链表上，由 loop 线程批量收回
+class BufferPool : noncopyable
+{
+public:
+    using ptr = std::shared_ptr<BufferPool>;
+
+    static const size_t kNumClasses   = 4;
+    static const size_t kMinBlockSize = 1024;
+    static const size_t kMaxBlockSize = kMinBlockSize << (2 * (kNumClasses - 1));
+    static const size_t kSlabSize     = 2 * 1024 * 1024;
+    static const size_t kScratchSize  = 64 * 1024;
+
+    struct Block
+    {
+        char*  data   = nullptr;
+        size_t size   = 0;
+        bool   pooled = false;  // false 表示来自堆
+    };
+
+    struct Stats
+    {
+        uint64_t hits;         // 从空闲链表直接取得
+        uint64_t misses;       // 需要从 slab 切分新 block
+        uint64_t heapAllocs;   // 超过 kMaxBlockSize 或非 loop 线程，退化为堆分配
+        uint64_t remoteFrees;  // 由其他线程归还
+        uint64_t slabBytes;    // 已向系统申请的 slab 总字节数
+        uint64_t inUseBytes;   // 当前借出的字节数 (含堆分配)
+    };
+
+    explicit BufferPool(bool useHugePages = false);
+    ~BufferPool();
+
+    // 返回的 block 至少有 size 字节，block.size 为实际大小
+    Block allocate(size_t size);
+    void  deallocate(const Block& block);
+
+    // 不经过内存池的堆分配，供没有 pool 的 Buffer 使用
+    static Block heapAllocate(size_t size);
+    static void  heapDeallocate(const Block& block);
+
+    // loop 内所有连接共享的读缓冲区，Buffer::readFd 用它代替栈上的 extrabuf
+    // 只能在 loop 线程中使用，且每次读完后必须立即归还 (见 Buffer::detachScratch)
+    char* scratch();
+
+    // 仅对之后申请的 slab 生效
+    void setUseHugePages(bool useHugePages) { useHugePages_ = useHugePages; }
+    bool useHugePages() const { return useHugePages_; }
+
+    // 任意线程可读
+    Stats stats() const;
+
+    bool isOwnerThread() const { return owner_ == std::this_thread::get_id(); }
+
+private:
+    struct FreeNode
+    {
+        FreeNode* next;
+    };
+
+    static int sizeClass(size_t size);
+    static size_t classSize(int cls) { return kMinBlockSize << (2 * cls); }
+
+    char* carve(size_t size);
+    void  newSlab();
+
+    const std::thread::id owner_;
+    bool                  useHugePages_;
+
+    FreeNode*              freeList_[kNumClasses];
+    std::atomic<FreeNode*> remoteFreeList_[kNumClasses];
+
+    struct Slab
+    {
+        char*  base;
+        size_t size;
+    };
+    std::vector<Slab> slabs_;
+    char*             slabCur_;
+    char*             slabEnd_;
+    char*             scratch_;
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> heapAllocs_;
+    std::atomic<uint64_t> remoteFrees_;
+    std::atomic<uint64_t> slabBytes_;
+    std::atomic<uint64_t> inUseBytes_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_BUFFERPOOL_H
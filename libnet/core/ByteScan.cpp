@@ -0,0 +1,238 @@
+#include "core/ByteScan.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__SSE2__)
+#    define LIBNET_SCAN_X86 1
+#    include <immintrin.h>
+#endif
+
+using namespace libnet;
+using namespace libnet::scan;
+
+namespace {
+
+// ---------------------------------------------------------------- scalar
+
+const char* findCRLFScalar(const char* begin, const char* end) {
+    while (end - begin >= 2) {
+        const char* cr = findByte(begin, end - 1, '\r');
+        if (cr == nullptr) {
+            return nullptr;
+        }
+        if (cr[1] == '\n') {
+            return cr;
+        }
+        begin = cr + 1;
+    }
+    return nullptr;
+}
+
+const char* findCRLFCRLFScalar(const char* begin, const char* end) {
+    while (end - begin >= 4) {
+        const char* crlf = findCRLFScalar(begin, end);
+        if (crlf == nullptr || end - crlf < 4) {
+            return nullptr;
+        }
+        if (crlf[2] == '\r' && crlf[3] == '\n') {
+            return crlf;
+        }
+        begin = crlf + 2;
+    }
+    return nullptr;
+}
+
+const char*
+findAnyOfScalar(const char* begin, const char* end, const ByteSet& set) {
+    for (; begin < end; ++begin) {
+        if (set.contains(*begin)) {
+            return begin;
+        }
+    }
+    return nullptr;
+}
+
+#ifdef LIBNET_SCAN_X86
+
+inline int lowestBit(uint32_t mask) {
+    return __builtin_ctz(mask);
+}
+
+// ---------------------------------------------------------------- SSE2
+
+const char* findCRLFSse2(const char* begin, const char* end) {
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    // 需要同时读取 [p, p+16) 与 [p+1, p+17)
+    for (; end - begin >= 17; begin += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i b =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + 1));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, cr), _mm_cmpeq_epi8(b, lf))));
+        if (mask != 0) {
+            return begin + lowestBit(mask);
+        }
+    }
+    return findCRLFScalar(begin, end);
+}
+
+const char* findCRLFCRLFSse2(const char* begin, const char* end) {
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    for (; end - begin >= 19; begin += 16) {
+        auto load = [begin](int offset) {
+            return _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(begin + offset));
+        };
+        __m128i m = _mm_and_si128(
+            _mm_and_si128(_mm_cmpeq_epi8(load(0), cr),
+                          _mm_cmpeq_epi8(load(1), lf)),
+            _mm_and_si128(_mm_cmpeq_epi8(load(2), cr),
+                          _mm_cmpeq_epi8(load(3), lf)));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(m));
+        if (mask != 0) {
+            return begin + lowestBit(mask);
+        }
+    }
+    return findCRLFCRLFScalar(begin, end);
+}
+
+const char*
+findAnyOfSse2(const char* begin, const char* end, const ByteSet& set) {
+    __m128i needles[ByteSet::kMaxBytes];
+    for (size_t i = 0; i < set.size(); ++i) {
+        needles[i] = _mm_set1_epi8(set.bytes()[i]);
+    }
+    for (; end - begin >= 16; begin += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i m = _mm_setzero_si128();
+        for (size_t i = 0; i < set.size(); ++i) {
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(v, needles[i]));
+        }
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(m));
+        if (mask != 0) {
+            return begin + lowestBit(mask);
+        }
+    }
+    return findAnyOfScalar(begin, end, set);
+}
+
+// ---------------------------------------------------------------- AVX2
+
+__attribute__((target("avx2"))) const char* findCRLFAvx2(const char* begin,
+                                                         const char* end) {
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    for (; end - begin >= 33; begin += 32) {
+        __m256i a =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + 1));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, cr),
+                             _mm256_cmpeq_epi8(b, lf))));
+        if (mask != 0) {
+            return begin + lowestBit(mask);
+        }
+    }
+    return findCRLFSse2(begin, end);
+}
+
+__attribute__((target("avx2"))) const char*
+findCRLFCRLFAvx2(const char* begin, const char* end) {
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    for (; end - begin >= 35; begin += 32) {
+        const __m256i* p = reinterpret_cast<const __m256i*>(begin);
+        __m256i m0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(p), cr);
+        __m256i m1 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(begin + 1)),
+            lf);
+        __m256i m2 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(begin + 2)),
+            cr);
+        __m256i m3 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(begin + 3)),
+            lf);
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_and_si256(m0, m1),
+                             _mm256_and_si256(m2, m3))));
+        if (mask != 0) {
+            return begin + lowestBit(mask);
+        }
+    }
+    return findCRLFCRLFSse2(begin, end);
+}
+
+__attribute__((target("avx2"))) const char*
+findAnyOfAvx2(const char* begin, const char* end, const ByteSet& set) {
+    __m256i needles[ByteSet::kMaxBytes];
+    for (size_t i = 0; i < set.size(); ++i) {
+        needles[i] = _mm256_set1_epi8(set.bytes()[i]);
+    }
+    for (; end - begin >= 32; begin += 32) {
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i m = _mm256_setzero_si256();
+        for (size_t i = 0; i < set.size(); ++i) {
+            m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, needles[i]));
+        }
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(m));
+        if (mask != 0) {
+            return begin + lowestBit(mask);
+        }
+    }
+    return findAnyOfSse2(begin, end, set);
+}
+
+#endif  // LIBNET_SCAN_X86
+
+// ---------------------------------------------------------------- dispatch
+
+struct Kernels
+{
+    const char* (*findCRLF)(const char*, const char*);
+    const char* (*findCRLFCRLF)(const char*, const char*);
+    const char* (*findAnyOf)(const char*, const char*, const ByteSet&);
+    const char* name;
+};
+
+Kernels selectKernels() {
+#ifdef LIBNET_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return { findCRLFAvx2, findCRLFCRLFAvx2, findAnyOfAvx2, "avx2" };
+    }
+    return { findCRLFSse2, findCRLFCRLFSse2, findAnyOfSse2, "sse2" };
+#else
+    return { findCRLFScalar, findCRLFCRLFScalar, findAnyOfScalar, "scalar" };
+#endif
+}
+
+const Kernels& kernels() {
+    static const Kernels k = selectKernels();
+    return k;
+}
+
+}  // anonymous namespace
+
+const char* scan::findCRLF(const char* begin, const char* end) {
+    return kernels().findCRLF(begin, end);
+}
+
+const char* scan::findCRLFCRLF(const char* begin, const char* end) {
+    return kernels().findCRLFCRLF(begin, end);
+}
+
+const char*
+scan::findAnyOf(const char* begin, const char* end, const ByteSet& set) {
+    return kernels().findAnyOf(begin, end, set);
+}
+
+const char* scan::isaName() {
+    return kernels().name;
+}
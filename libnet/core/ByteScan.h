@@ -0,0 +1,55 @@
+#ifndef LIBNET_BYTESCAN_H
+#define LIBNET_BYTESCAN_H
+
+#include <cstddef>
+#include <cstring>
+
+namespace libnet {
+
+// 协议解析用的字节扫描函数 : SSE2/AVX2 向量化实现，运行时按 CPU 选择，
+// 其他平台退化为标量实现。所有函数在 [begin, end) 中查找，找不到返回 nullptr
+namespace scan {
+
+    // 最多 8 个字节的字节集合，用于一次扫描同时查找多个分隔符
+    class ByteSet
+    {
+    public:
+        static const size_t kMaxBytes = 8;
+
+        explicit ByteSet(const char* bytes) : size_(0) {
+            ::memset(table_, 0, sizeof(table_));
+            for (; *bytes != '\0' && size_ < kMaxBytes; ++bytes) {
+                bytes_[size_++] = *bytes;
+                table_[static_cast<unsigned char>(*bytes)] = true;
+            }
+        }
+
+        bool contains(char c) const {
+            return table_[static_cast<unsigned char>(c)];
+        }
+        size_t      size() const { return size_; }
+        const char* bytes() const { return bytes_; }
+
+    private:
+        char   bytes_[kMaxBytes];
+        size_t size_;
+        bool   table_[256];
+    };
+
+    const char* findCRLF(const char* begin, const char* end);
+    const char* findCRLFCRLF(const char* begin, const char* end);
+    const char* findAnyOf(const char* begin, const char* end, const ByteSet& set);
+
+    inline const char* findByte(const char* begin, const char* end, char c) {
+        // glibc 的 memchr 本身已经向量化
+        return static_cast<const char*>(::memchr(begin, c, end - begin));
+    }
+
+    // 当前使用的实现 : "avx2" / "sse2" / "scalar"
+    const char* isaName();
+
+}  // namespace scan
+
+}  // namespace libnet
+
+#endif  // LIBNET_BYTESCAN_H
@@ -1,8 +1,10 @@
 #ifndef LIBNET_CALLBACKS_H
 #define LIBNET_CALLBACKS_H
 
+#include "utils/InlineFunction.h"
 #include <functional>
 #include <memory>
+#include <string>
 
 namespace libnet {
 using namespace std::string_literals;
@@ -28,13 +30,20 @@ using HighWaterMarkCallback =
     std::function<void(const TcpConnectionPtr&,
                        size_t)>;  // 消息阻塞发不出积累高水位时的回调函数
 using MessageCallback = std::function<void(const TcpConnectionPtr&, Buffer&)>;
+using IdleTimeoutCallback =
+    std::function<void(const TcpConnectionPtr&)>;  // 连接空闲超时的回调函数
 using ErrorCallback   = std::function<void()>;
 using NewConnectionCallback = std::function<
     void(int cfd, const InetAddress& local, const InetAddress& peer)>;
 
-using Task               = std::function<void()>;
-using TimerCallback      = std::function<void()>;
+// 投递到 loop / 线程池的任务与定时器回调只移动不复制，
+// 64 字节以内的捕获不分配内存
+using Task               = InlineFunction<void()>;
+using TimerCallback      = InlineFunction<void()>;
 using ThreadInitCallback = std::function<void(size_t index)>;
+// EventLoop 各阶段的钩子，IdleHook 返回 true 表示还有后台工作要做
+using LoopHook = std::function<void()>;
+using IdleHook = std::function<bool()>;
 
 void defaultThreadInitCallback(size_t index);
 void defaultConnectionCallback(const TcpConnectionPtr& conn);
@@ -11,45 +11,78 @@ Channel::Channel(EventLoop* loop, int fd)
       revents_(0),
       tied_(false),
       handlingEvents_(false),
-      polling_(false) {}
+      polling_(false),
+      edgeTriggered_(false) {}
 
 Channel::~Channel() {
     assert(!handlingEvents_);
 }
 
-void Channel::handleEvents() {
+int Channel::handleEvents() {
     loop_->assertInLoopThread();
 
     if (tied_) {
         auto guard = tie_.lock();
         if (guard) {
-            handleEventsWithGuard();
+            return handleEventsWithGuard();
         }
+        return 0;
     }
-    else {
-        handleEventsWithGuard();
-    }
+    return handleEventsWithGuard();
 }
 
-void Channel::handleEventsWithGuard() {
+int Channel::handleEventsWithGuard() {
+    int handlers    = 0;
     handlingEvents_ = true;
     if ((revents_ & EPOLLHUP) && !(revents_ & EPOLLIN)) {
-        if (closeCallback_)
+        if (closeCallback_) {
+            handlers |= kCloseHandler;
             closeCallback_();
+        }
     }
     if (revents_ & EPOLLERR) {
-        if (errorCallback_)
+        if (errorCallback_) {
+            handlers |= kErrorHandler;
             errorCallback_();
+        }
     }
     if (revents_ & (EPOLLIN | EPOLLPRI | EPOLLRDHUP)) {
-        if (readCallback_)
+        if (readCallback_) {
+            handlers |= kReadHandler;
             readCallback_();
+        }
     }
     if (revents_ & EPOLLOUT) {
-        if (writeCallback_)
+        if (writeCallback_) {
+            handlers |= kWriteHandler;
             writeCallback_();
+        }
     }
     handlingEvents_ = false;
+    return handlers;
+}
+
+std::string Channel::handlersToString(int handlers) {
+    std::string result;
+    auto        append = [&result](const char* name) {
+        if (!result.empty()) {
+            result += '|';
+        }
+        result += name;
+    };
+    if (handlers & kCloseHandler) {
+        append("close");
+    }
+    if (handlers & kErrorHandler) {
+        append("error");
+    }
+    if (handlers & kReadHandler) {
+        append("read");
+    }
+    if (handlers & kWriteHandler) {
+        append("write");
+    }
+    return result.empty() ? "none" : result;
 }
 
 void Channel::update() {
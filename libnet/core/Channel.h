@@ -3,6 +3,7 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 #include <sys/epoll.h>
 
 #include "utils/noncopyable.h"
@@ -19,7 +20,18 @@ public:
     Channel(EventLoop* loop, int fd);
     ~Channel();
 
-    void handleEvents();
+    // handleEvents 实际调用的回调，可按位或
+    enum Handler
+    {
+        kCloseHandler = 1,
+        kErrorHandler = 2,
+        kReadHandler  = 4,
+        kWriteHandler = 8,
+    };
+
+    // 返回实际调用了哪些回调 (Handler 的组合)，用于记录慢回调；
+    // 回调中 channel 可能已被销毁，返回后不能再访问它
+    int handleEvents();
 
     void setReadCallback(const EventCallback& readCallback) {
         readCallback_ = readCallback;
@@ -37,7 +49,10 @@ public:
     int fd() const { return fd_; }
 
     int  events() const { return events_; }
+    int  revents() const { return revents_; }
     void setRevents(int revents) { revents_ = revents; }
+    // handleEvents 的返回值，如 "read|write"，用于日志
+    static std::string handlersToString(int handlers);
 
     bool polling() const { return polling_; }
     void setPolling(bool polling) { polling_ = polling; }
@@ -62,6 +77,16 @@ public:
         events_ = kNoneEvent;
         update();
     }
+    // 同时注册读写事件，只需一次 epoll_ctl
+    void enableAll() {
+        events_ |= kReadEvent | kWriteEvent;
+        update();
+    }
+
+    // 边沿触发 (EPOLLET) : 只在状态变化时通知一次，回调必须读/写到 EAGAIN
+    // 须在第一次注册事件之前设置
+    void setEdgeTriggered(bool on) { edgeTriggered_ = on; }
+    bool edgeTriggered() const { return edgeTriggered_; }
 
     bool isNoneEvents() const { return events_ == 0; }
     bool isReading() const { return events_ & EPOLLIN; }
@@ -78,7 +103,7 @@ public:
 
 private:
     void update();
-    void handleEventsWithGuard();
+    int  handleEventsWithGuard();
 
     static const int kNoneEvent  = 0;
     static const int kReadEvent  = EPOLLIN | EPOLLPRI;
@@ -93,6 +118,7 @@ private:
     bool                tied_;
     bool                handlingEvents_;
     bool                polling_;
+    bool                edgeTriggered_;
 
     EventCallback readCallback_;
     EventCallback writeCallback_;
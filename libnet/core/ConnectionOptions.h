@@ -0,0 +1,35 @@
+#ifndef LIBNET_CONNECTIONOPTIONS_H
+#define LIBNET_CONNECTIONOPTIONS_H
+
+#include <cstddef>
+
+namespace libnet {
+
+// TcpServer 在创建连接时统一应用到每个 TcpConnection 上的选项
+struct ConnectionOptions
+{
+    // 输入/输出缓冲区清空后立即把存储还给 loop 的内存池，
+    // 使大量空闲长连接几乎不占用 Buffer 内存
+    bool releaseIdleBuffers = false;
+
+    // 不小于该长度的共享 payload 以 MSG_ZEROCOPY 发送，0 表示关闭
+    // 零拷贝需要固定页面并处理完成通知，数据较小时反而更慢
+    static const size_t kDefaultZeroCopyThreshold = 64 * 1024;
+    size_t              zeroCopyThreshold         = 0;
+
+    // 回调中的 send 只追加到输出队列，本轮事件处理完后每个连接合并为
+    // 一次 writev 写出，避免多次 send 产生多次系统调用
+    bool deferredFlush = false;
+
+    // 连接以 EPOLLET 注册，读写都进行到 EAGAIN 为止；可写事件常驻，
+    // 输出缓冲区写满/写空时不再调用 epoll_ctl
+    bool edgeTriggered = false;
+
+    // 连接的 SO_BUSY_POLL 时长（微秒），0 表示不设置
+    // 读取时在驱动队列上轮询而不是等待中断，配合 EventLoop::setBusyPoll 使用
+    int busyPollMicros = 0;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_CONNECTIONOPTIONS_H
@@ -1,5 +1,11 @@
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <limits>
+#include <linux/time_types.h>
+#include <ratio>
 #include <sys/epoll.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
 #include "core/EPoller.h"
@@ -8,8 +14,36 @@
 
 using namespace libnet;
 
+namespace {
+
+// glibc 2.35 才提供 epoll_pwait2 的封装，直接使用系统调用 (Linux 5.11)
+int epollPwait2(int                             epfd,
+                struct epoll_event*             events,
+                int                             maxEvents,
+                const struct __kernel_timespec* timeout) {
+#ifdef __NR_epoll_pwait2
+    return static_cast<int>(::syscall(__NR_epoll_pwait2, epfd, events,
+                                      maxEvents, timeout, nullptr, 0));
+#else
+    (void)epfd;
+    (void)events;
+    (void)maxEvents;
+    (void)timeout;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+}  // anonymous namespace
+
 EPoller::EPoller(EventLoop* loop)
-    : loop_(loop), events_(128), epollfd_(::epoll_create1(EPOLL_CLOEXEC)) {
+    : Poller(loop),
+      events_(128),
+      epollfd_(::epoll_create1(EPOLL_CLOEXEC)),
+      entries_(1024),
+      active_(nullptr),
+      batch_(0),
+      pwait2_(true) {
     if (epollfd_ == -1) {
         LOG_SYSFATAL << "Epoller::epoll_create1()";
     }
@@ -20,10 +54,14 @@ EPoller::~EPoller() {
 }
 
 // return activeChannels to EventLoop::loop
-void EPoller::poll(ChannelList& activeChannels, int timeout) {
+void EPoller::poll(ChannelList& activeChannels, Nanoseconds timeout) {
     loop_->assertInLoopThread();
     int max_events = static_cast<int>(events_.size());
-    int num_events = epoll_wait(epollfd_, events_.data(), max_events, timeout);
+    applyUpdates();
+    ++stats_.pollCalls;
+    ++batch_;
+    active_ = &activeChannels;
+    int num_events = wait(max_events, timeout);
     if (num_events == -1) {
         if (errno != EINTR)
             LOG_SYSERR << "EPoller::poll()";
@@ -31,9 +69,20 @@ void EPoller::poll(ChannelList& activeChannels, int timeout) {
     else if (num_events > 0) {
         LOG_TRACE << num_events << " events happend";
         for (int i = 0; i < num_events; ++i) {
-            Channel* channel = static_cast<Channel*>(events_[i].data.ptr);
-            channel->setRevents(events_[i].events);
-            activeChannels.push_back(channel);
+            if (i + 2 < num_events) {
+                __builtin_prefetch(
+                    &entries_[static_cast<uint32_t>(events_[i + 2].data.u64)]);
+            }
+            const uint64_t data = events_[i].data.u64;
+            Entry& entry = entries_[static_cast<uint32_t>(data)];
+            if (entry.channel == nullptr ||
+                entry.generation != static_cast<uint32_t>(data >> 32)) {
+                continue;
+            }
+            entry.channel->setRevents(events_[i].events);
+            entry.batch       = batch_;
+            entry.activeIndex = static_cast<uint32_t>(activeChannels.size());
+            activeChannels.push_back(entry.channel);
         }
         if (num_events == max_events) {
             events_.resize(2 * events_.size());
@@ -44,30 +93,123 @@ void EPoller::poll(ChannelList& activeChannels, int timeout) {
     }
 }
 
+int EPoller::wait(int maxEvents, Nanoseconds timeout) {
+    const int64_t kNanosPerMilli = 1000 * 1000;
+    const int64_t ns             = timeout.count();
+    if (ns > 0 && ns % kNanosPerMilli != 0 && pwait2_) {
+        struct __kernel_timespec ts;
+        ts.tv_sec  = ns / std::nano::den;
+        ts.tv_nsec = ns % std::nano::den;
+        int n = epollPwait2(epollfd_, events_.data(), maxEvents, &ts);
+        if (n != -1 || errno != ENOSYS) {
+            return n;
+        }
+        LOG_WARN << "EPoller epoll_pwait2 unsupported, timeouts rounded up to "
+                    "milliseconds";
+        pwait2_ = false;
+    }
+    // 向上取整到毫秒，避免定时器未到期就醒来
+    int ms = -1;
+    if (ns >= 0) {
+        ms = static_cast<int>(
+            std::min<int64_t>((ns + kNanosPerMilli - 1) / kNanosPerMilli,
+                              std::numeric_limits<int>::max()));
+    }
+    return ::epoll_wait(epollfd_, events_.data(), maxEvents, ms);
+}
+
 // onConnection or onDisconnection or onModify
 void EPoller::updateChannel(Channel* channel) {
     loop_->assertInLoopThread();
-    int op = 0;
+    const size_t fd = static_cast<size_t>(channel->fd());
+    if (fd >= entries_.size()) {
+        entries_.resize(std::max(fd + 1, 2 * entries_.size()));
+    }
+    Entry& entry = entries_[fd];
     if (!channel->polling()) {
         assert(!channel->isNoneEvents());
-        op = EPOLL_CTL_ADD;
         channel->setPolling(true);
+        entry.channel = channel;
+        ++entry.generation;
+    }
+    else if (channel->isNoneEvents()) {
+        channel->setPolling(false);
+        removeChannel(channel, entry);
+        return;
     }
-    else if (!channel->isNoneEvents()) {
-        op = EPOLL_CTL_MOD;
+    const uint32_t events = static_cast<uint32_t>(channel->events());
+    if (channel->edgeTriggered() && (events & ~entry.requested) != 0) {
+        entry.rearm = true;
+    }
+    entry.requested = events;
+    if (entry.dirty) {
+        ++stats_.ctlAvoided;  // 与尚未提交的修改合并
     }
     else {
-        op = EPOLL_CTL_DEL;
-        channel->setPolling(false);
+        entry.dirty = true;
+        dirty_.push_back(static_cast<int>(fd));
+    }
+}
+
+void EPoller::removeChannel(Channel* channel, Entry& entry) {
+    entry.channel = nullptr;
+    ++entry.generation;
+    // 本批中尚未分发的事件不再交给该 channel
+    if (entry.batch == batch_ && active_ != nullptr &&
+        entry.activeIndex < active_->size() &&
+        (*active_)[entry.activeIndex] == channel) {
+        (*active_)[entry.activeIndex] = nullptr;
+    }
+    entry.requested = 0;
+    entry.rearm     = false;
+    if (entry.dirty) {
+        entry.dirty = false;
+        ++stats_.ctlAvoided;
+    }
+    if (entry.registered) {
+        control(EPOLL_CTL_DEL, channel->fd(), entry);
+        entry.registered = false;
+    }
+    else {
+        ++stats_.ctlAvoided;  // 添加尚未提交，直接抵消
     }
-    updateChannel(op, channel);
 }
 
-void EPoller::updateChannel(int op, Channel* channel) {
+void EPoller::applyUpdates() {
+    for (int fd : dirty_) {
+        Entry& entry = entries_[fd];
+        if (!entry.dirty) {
+            continue;
+        }
+        entry.dirty = false;
+        const bool rearm = entry.rearm;
+        entry.rearm      = false;
+        uint32_t events = static_cast<uint32_t>(entry.channel->events());
+        if (entry.channel->edgeTriggered()) {
+            events |= EPOLLET;
+        }
+        if (!entry.registered) {
+            entry.events = events;
+            control(EPOLL_CTL_ADD, fd, entry);
+            entry.registered = true;
+        }
+        else if (events != entry.events || rearm) {
+            entry.events = events;
+            control(EPOLL_CTL_MOD, fd, entry);
+        }
+        else {
+            ++stats_.ctlAvoided;  // 本轮的修改最终回到了原状
+        }
+    }
+    dirty_.clear();
+}
+
+void EPoller::control(int op, int fd, Entry& entry) {
     struct epoll_event event;
-    event.events   = channel->events();
-    event.data.ptr = channel;
-    int ret        = ::epoll_ctl(epollfd_, op, channel->fd(), &event);
+    event.events   = entry.events;
+    event.data.u64 = eventData(fd, entry.generation);
+    ++stats_.ctlCalls;
+    int ret = ::epoll_ctl(epollfd_, op, fd, &event);
     if (ret == -1)
-        LOG_SYSERR << "EPoller::updateChannel(op, channel)";
-}
\ No newline at end of file
+        LOG_SYSERR << "EPoller::control() op=" << op << " fd=" << fd;
+}
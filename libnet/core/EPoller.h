@@ -1,32 +1,69 @@
 #ifndef LIBNET_EPOLLER_H
 #define LIBNET_EPOLLER_H
 
-#include "utils/noncopyable.h"
+#include "core/Poller.h"
+#include <cstdint>
 #include <vector>
 
-namespace libnet {
+struct epoll_event;
 
-class EventLoop;
-class Channel;
+namespace libnet {
 
-class EPoller : noncopyable
+class EPoller : public Poller
 {
 public:
-    using ChannelList = std::vector<Channel*>;
-    using EventList   = std::vector<struct epoll_event>;
+    using EventList = std::vector<struct epoll_event>;
 
     explicit EPoller(EventLoop* loop);
-    ~EPoller();
+    ~EPoller() override;
+
+    void poll(ChannelList& activeChannels,
+              Nanoseconds  timeout = Nanoseconds(-1)) override;
+    void updateChannel(Channel* channel) override;
 
-    void poll(ChannelList& activeChannels, int timeout = -1);
-    void updateChannel(Channel* channel);
+    const char* name() const override { return "epoll"; }
 
 private:
-    void updateChannel(int op, Channel* channel);
+    // 以 fd 为下标的 channel 表，epoll_event.data.u64 保存 fd 与 generation
+    // 分发时不必追随 epoll 给出的裸指针，fd 复用或同一批中已移除的 channel
+    // 的事件按 generation 丢弃
+    struct Entry
+    {
+        Channel* channel     = nullptr;
+        uint32_t generation  = 0;
+        uint32_t activeIndex = 0;  // 在本批 activeChannels 中的位置
+        uint64_t batch       = 0;  // 最近一次出现在 activeChannels 中的批次
+        uint32_t events      = 0;  // 内核中登记的事件
+        uint32_t requested   = 0;  // 最近一次 updateChannel 时关注的事件
+        bool     registered  = false;
+        bool     dirty       = false;  // 有尚未提交给内核的修改
+        // 边沿触发时有事件被重新打开 : 即使最终的事件不变也要 EPOLL_CTL_MOD，
+        // 内核据此重新检查就绪状态，否则已就绪的 fd 不会再通知
+        bool     rearm       = false;
+    };
+
+    // 关注事件的修改先记在 dirty_ 中，下一次 epoll_wait 之前统一提交，
+    // 同一轮中相互抵消或重复的修改不再调用 epoll_ctl (边沿触发的 channel
+    // 重新打开了事件时除外)；删除立即生效，
+    // 因为 channel 随后就可能被析构、fd 被关闭
+    void applyUpdates();
+    // 超时不是整毫秒时使用 epoll_pwait2，内核不支持时退回 epoll_wait
+    int  wait(int maxEvents, Nanoseconds timeout);
+    void removeChannel(Channel* channel, Entry& entry);
+    void control(int op, int fd, Entry& entry);
+
+    static uint64_t eventData(int fd, uint32_t generation) {
+        return static_cast<uint64_t>(generation) << 32 |
+               static_cast<uint32_t>(fd);
+    }
 
-    EventLoop* loop_;
-    EventList  events_;
-    int        epollfd_;
+    EventList          events_;
+    int                epollfd_;
+    std::vector<Entry> entries_;
+    ChannelList*       active_;  // 正在分发的 activeChannels
+    std::vector<int>   dirty_;
+    uint64_t           batch_;
+    bool               pwait2_;  // 内核是否支持 epoll_pwait2
 };
 
 }  // namespace libnet
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <memory>
 #include <numeric>
 #include <signal.h>
@@ -9,9 +11,12 @@
 #include <unistd.h>
 #include <utility>
 
-#include "core/EPoller.h"
 #include "core/EventLoop.h"
+#include "core/IdleWheel.h"
+#include "core/LoopWatchdog.h"
+#include "core/Poller.h"
 #include "core/Timestamp.h"
+#include "core/ZeroCopyGraveyard.h"
 #include "logger/Logger.h"
 
 using namespace libnet;
@@ -20,6 +25,12 @@ namespace {
 
 __thread EventLoop* t_loopInThisThread = nullptr;
 
+int64_t steadyNanos() {
+    return std::chrono::duration_cast<Nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
 class IgnoreSigPipe
 {
 public:
@@ -28,16 +39,48 @@ public:
 
 IgnoreSigPipe ignoreSigPipe;
 
+// 只由 loop 线程写入的计数器，不需要原子的读改写
+void accumulate(std::atomic<int64_t>& counter, int64_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta,
+                  std::memory_order_relaxed);
+}
+
 }  // anonymous namespace
 
 EventLoop::EventLoop()
     : tid_(std::this_thread::get_id()),
       quit_(false),
-      poller_(std::make_unique<EPoller>(this)),
+      poller_(Poller::newDefaultPoller(this)),
+      bufferPool_(std::make_shared<BufferPool>()),
       timerQueue_(this),
+      pollReturnTime_(steadyNanos()),
+      idleWheel_(std::make_unique<IdleWheel>(this)),
+      zeroCopyGraveyard_(std::make_unique<ZeroCopyGraveyard>(this)),
       doingPendingTasks_(false),
       wakeupFd_(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
-      wakeupChannel_(std::make_unique<Channel>(this, wakeupFd_)) {
+      wakeupChannel_(std::make_unique<Channel>(this, wakeupFd_)),
+      wakeupPending_(false),
+      bulkMaxTasks_(kDefaultBulkTasks),
+      bulkMaxNanos_(Nanoseconds(1ms).count()),
+      runningHooks_(false),
+      nextHookId_(1),
+      busyPollMax_(0),
+      busyPollBudget_(0),
+      idleGapEwma_(0),
+      spinNanos_(0),
+      sleepNanos_(0),
+      spinHits_(0),
+      sleeps_(0),
+      iterations_(0),
+      busyNanos_(0),
+      idleNanos_(0),
+      slowCallbackNanos_(kDefaultSlowCallbackThreshold.count()),
+      threadHandle_(::pthread_self()),
+      heartbeat_(0),
+      phase_(kPolling),
+      currentFd_(-1),
+      phaseSince_(0),
+      watchdog_(nullptr) {
     // FIXME : LOG tid
     LOG_INFO << "EventLoop createt " << this << " in thread ";
     if (wakeupFd_ <= 0) {
@@ -55,6 +98,10 @@ EventLoop::EventLoop()
 }
 
 EventLoop::~EventLoop() {
+    LoopWatchdog* watchdog = watchdog_.load(std::memory_order_acquire);
+    if (watchdog != nullptr) {
+        watchdog->unwatch(this);
+    }
     assert(t_loopInThisThread == this);
     t_loopInThisThread = nullptr;
 }
@@ -66,20 +113,163 @@ EventLoop* EventLoop::getEventLoopOfCurrentThread() {
 void EventLoop::loop() {
     assertInLoopThread();
     LOG_TRACE << "EventLoop " << this << " polling";
-    quit_ = false;
+    quit_       = false;
+    int64_t now = steadyNanos();
     while (!quit_) {
         activeChannels_.clear();
 
-        poller_->poll(activeChannels_);
+        const int64_t pollStart = now;
+        beat(kPolling, -1, now);
+        pollEvents();
+        const int64_t pollEnd = steadyNanos();
+        pollReturnTime_       = pollEnd;
+        const int64_t slow = slowCallbackNanos_.load(std::memory_order_relaxed);
 
-        for (auto& channel : activeChannels_) {
-            channel->handleEvents();
+        const size_t numActive = activeChannels_.size();
+        pollWait_.record(pollEnd - pollStart);
+        eventsPerPoll_.record(static_cast<int64_t>(numActive));
+        now = pollEnd;
+        for (size_t i = 0; i < numActive; ++i) {
+            if (i + 1 < numActive && activeChannels_[i + 1] != nullptr) {
+                __builtin_prefetch(activeChannels_[i + 1]);
+            }
+            // 同一批中已被移除的 channel 由 Poller 置空
+            Channel* channel = activeChannels_[i];
+            if (channel != nullptr) {
+                // 回调中 channel 可能被销毁，先记下 fd
+                const int fd = channel->fd();
+                beat(kIoCallback, fd, now);
+                const int     handlers = channel->handleEvents();
+                const int64_t end      = steadyNanos();
+                dispatch_.record(end - now);
+                if (slow > 0 && end - now >= slow) {
+                    reportSlowCallback("I/O callback", fd, handlers, end - now);
+                }
+                now = end;
+            }
+        }
+        if (!timerQueue_.useTimerfd()) {
+            beat(kTimers, -1, now);
+            timerQueue_.handleExpired();
+            const int64_t end = steadyNanos();
+            if (slow > 0 && end - now >= slow) {
+                reportSlowCallback("timers", -1, 0, end - now);
+            }
+            now = end;
         }
+        beat(kPendingTasks, -1, now);
+        doFlushTasks();
         doPendingTasks();
+        if (!hooks_[kCheck].empty()) {
+            runHooks(kCheck);
+            doFlushTasks();
+        }
+
+        now = steadyNanos();
+        iterations_.store(iterations_.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+        accumulate(idleNanos_, pollEnd - pollStart);
+        accumulate(busyNanos_, now - pollEnd);
     }
     LOG_TRACE << "EventLoop " << this << " stop looping";
 }
 
+void EventLoop::pollEvents() {
+    if (!hooks_[kPrepare].empty()) {
+        runHooks(kPrepare);
+        doFlushTasks();
+    }
+    // 不使用 timerfd 时以最早的定时器到期时间作为超时；
+    // 上一轮留下了 kBulk task 时不阻塞
+    Nanoseconds timeout = timerQueue_.useTimerfd() ? Nanoseconds(-1)
+                                                   : timerQueue_.nextTimeout();
+    if (!lanes_[kBulk].queue.empty()) {
+        timeout = Nanoseconds::zero();
+    }
+    if (!hooks_[kIdle].empty() && timeout.count() != 0) {
+        // 先不阻塞地 poll 一次，没有就绪事件才算空闲
+        poller_->poll(activeChannels_, Nanoseconds::zero());
+        if (!activeChannels_.empty()) {
+            return;
+        }
+        if (runHooks(kIdle)) {
+            timeout = Nanoseconds::zero();
+        }
+        doFlushTasks();
+    }
+    // 钩子中在 loop 线程 queueInLoop 的 task 不会唤醒 loop，不能阻塞
+    if (!lanes_[kUrgent].queue.empty()) {
+        timeout = Nanoseconds::zero();
+    }
+    const int64_t maxSpin = busyPollMax_.load(std::memory_order_relaxed);
+    if (maxSpin <= 0) {
+        poller_->poll(activeChannels_, timeout);
+        return;
+    }
+    using std::chrono::steady_clock;
+    const auto idleStart = steady_clock::now();
+    auto       spinEnd =
+        idleStart +
+        Nanoseconds(busyPollBudget_.load(std::memory_order_relaxed));
+    if (timeout.count() >= 0) {
+        spinEnd = std::min(spinEnd, idleStart + timeout);
+    }
+    auto now = idleStart;
+    while (now < spinEnd) {
+        poller_->poll(activeChannels_, Nanoseconds::zero());
+        now = steady_clock::now();
+        if (!activeChannels_.empty()) {
+            break;
+        }
+    }
+    spinNanos_.fetch_add((now - idleStart).count(), std::memory_order_relaxed);
+    if (activeChannels_.empty()) {
+        Nanoseconds remaining = timeout;
+        if (timeout.count() >= 0) {
+            remaining = std::max(Nanoseconds::zero(),
+                                 timeout - (now - idleStart));
+        }
+        poller_->poll(activeChannels_, remaining);
+        const auto woken = steady_clock::now();
+        sleepNanos_.fetch_add((woken - now).count(),
+                              std::memory_order_relaxed);
+        sleeps_.fetch_add(1, std::memory_order_relaxed);
+        now = woken;
+    }
+    else {
+        spinHits_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 预算取平均间隔的两倍，覆盖大部分到达；平均间隔超过 maxSpin 时
+    // 自旋大多落空，只浪费 CPU，此时直接阻塞
+    const int64_t gap = (now - idleStart).count();
+    idleGapEwma_ += (gap - idleGapEwma_) / 8;
+    const int64_t budget =
+        idleGapEwma_ > maxSpin ? 0 : std::min(maxSpin, 2 * idleGapEwma_);
+    busyPollBudget_.store(budget, std::memory_order_relaxed);
+}
+
+void EventLoop::setBusyPoll(Nanoseconds maxSpin) {
+    busyPollMax_.store(maxSpin.count(), std::memory_order_relaxed);
+    busyPollBudget_.store(maxSpin.count(), std::memory_order_relaxed);
+}
+
+EventLoop::BusyPollStats EventLoop::busyPollStats() const {
+    return { Nanoseconds(spinNanos_.load(std::memory_order_relaxed)),
+             Nanoseconds(sleepNanos_.load(std::memory_order_relaxed)),
+             spinHits_.load(std::memory_order_relaxed),
+             sleeps_.load(std::memory_order_relaxed),
+             Nanoseconds(busyPollBudget_.load(std::memory_order_relaxed)) };
+}
+
+void EventLoop::setUseTimerfd(bool on) {
+    runInLoop([this, on] { timerQueue_.setUseTimerfd(on); });
+}
+
+void EventLoop::setTimingWheel(Nanoseconds resolution) {
+    runInLoop([this, resolution] { timerQueue_.setTimingWheel(resolution); });
+}
+
 void EventLoop::quit() {
     assert(!quit_);
     quit_ = true;
@@ -100,35 +290,197 @@ void EventLoop::removeChannel(Channel* channel) {
     LOG_TRACE << "EventLoop " << this << " remove Channel " << channel;
 }
 
-Timer::sptr EventLoop::runAt(Timestamp when, TimerCallback callback) {
+TimerId EventLoop::runAt(Timestamp when, TimerCallback callback) {
     return timerQueue_.addTimer(std::move(callback), when);
 }
 
-Timer::sptr EventLoop::runAfter(Nanoseconds interval, TimerCallback callback) {
+TimerId EventLoop::runAfter(Nanoseconds interval, TimerCallback callback) {
     return timerQueue_.addTimer(std::move(callback), clock::now() + interval,
                                 interval, false);
 }
 
-Timer::sptr EventLoop::runEvery(Nanoseconds interval, TimerCallback callback) {
+TimerId EventLoop::runEvery(Nanoseconds interval, TimerCallback callback) {
     return timerQueue_.addTimer(std::move(callback), clock::now() + interval,
                                 interval, true);
 }
 
-void EventLoop::cancelTimer(Timer::sptr timer) {
-    timerQueue_.cancelTimer(timer);
+void EventLoop::cancelTimer(TimerId timerId) {
+    timerQueue_.cancelTimer(timerId);
 }
 
-void EventLoop::runInLoop(const Task& task) {
+void EventLoop::updateTimer(TimerId timerId, Timestamp when) {
+    timerQueue_.updateTimer(timerId, when);
+}
+
+void EventLoop::runInLoop(Task&& task) {
     if (isInLoopThread()) {
         task();
     }
     else {
-        queueInLoop(task);
+        queueInLoop(std::move(task));
     }
 }
 
-void EventLoop::runInLoop(Task&& task) {
-    if (isInLoopThread()) {
+void EventLoop::queueInLoop(Task&& task, Lane lane) {
+    TaskLane& taskLane = lanes_[lane];
+    taskLane.depth.fetch_add(1, std::memory_order_relaxed);
+    taskLane.queue.push(PendingTask{ std::move(task), steadyNanos() });
+    // push 完成后再检查标志：看到 true 说明 loop 还没有清除它，
+    // 清除之后的 doPendingTasks 一定能取到这个 task
+    if ((!isInLoopThread() || doingPendingTasks_) &&
+        !wakeupPending_.exchange(true)) {
+        wakeup();
+    }
+}
+
+void EventLoop::doPendingTasks() {
+    assertInLoopThread();
+    // 用 exchange 而不是 store：与看到 true 而未唤醒的生产者同步，
+    // 保证它们已完成的 push 在下面可见
+    wakeupPending_.exchange(false);
+    // 只执行本轮开始时已有的 task，执行中新加入的留到下一轮
+    doingPendingTasks_ = true;
+    int64_t   now    = steadyNanos();
+    TaskLane& urgent = lanes_[kUrgent];
+    urgent.queue.consume([this, &urgent, &now](PendingTask& pending) {
+        now = runPendingTask(urgent, pending, now);
+        return true;
+    });
+
+    const size_t  maxTasks = bulkMaxTasks_.load(std::memory_order_relaxed);
+    const int64_t maxNanos = bulkMaxNanos_.load(std::memory_order_relaxed);
+    const int64_t start    = now;
+    size_t        count    = 0;
+    TaskLane&     bulk     = lanes_[kBulk];
+    bulk.queue.consume([&](PendingTask& pending) {
+        now = runPendingTask(bulk, pending, now);
+        ++count;
+        if (maxTasks > 0 && count >= maxTasks) {
+            return false;
+        }
+        if (maxNanos > 0 && now - start >= maxNanos) {
+            return false;
+        }
+        return urgent.queue.empty();
+    });
+    // pending task 中的 send 同样在这里合并写出
+    doFlushTasks();
+    doingPendingTasks_ = false;
+}
+
+int64_t EventLoop::runPendingTask(TaskLane&    lane,
+                                  PendingTask& pending,
+                                  int64_t      now) {
+    beat(kPendingTasks, -1, now);
+    const int64_t delay = now - pending.queuedAt;
+    accumulate(lane.delayNanos, delay);
+    if (delay > lane.maxDelayNanos.load(std::memory_order_relaxed)) {
+        lane.maxDelayNanos.store(delay, std::memory_order_relaxed);
+    }
+    taskDelay_.record(delay);
+    pending.task();
+    pending.task = nullptr;
+    lane.executed.fetch_add(1, std::memory_order_relaxed);
+    lane.depth.fetch_sub(1, std::memory_order_relaxed);
+
+    const int64_t end  = steadyNanos();
+    const int64_t slow = slowCallbackNanos_.load(std::memory_order_relaxed);
+    if (slow > 0 && end - now >= slow) {
+        reportSlowCallback(&lane == &lanes_[kUrgent] ? "urgent task"
+                                                     : "bulk task",
+                           -1, 0, end - now);
+    }
+    return end;
+}
+
+void EventLoop::reportSlowCallback(const char* what,
+                                   int         fd,
+                                   int         handlers,
+                                   int64_t     nanos) {
+    if (fd >= 0) {
+        LOG_WARN << "EventLoop " << this << " slow " << what << " fd=" << fd
+                 << " (" << Channel::handlersToString(handlers) << ") took "
+                 << nanos / 1000 << "us";
+    }
+    else {
+        LOG_WARN << "EventLoop " << this << " slow " << what << " took "
+                 << nanos / 1000 << "us";
+    }
+}
+
+const char* EventLoop::phaseName(Phase phase) {
+    switch (phase) {
+        case kPolling: return "polling";
+        case kIoCallback: return "I/O callback";
+        case kTimers: return "timers";
+        case kPendingTasks: return "pending tasks";
+        case kLoopHooks: return "loop hooks";
+    }
+    return "unknown";
+}
+
+EventLoop::Progress EventLoop::progress() const {
+    Progress result;
+    result.heartbeat = heartbeat_.load(std::memory_order_acquire);
+    result.phase     = static_cast<Phase>(phase_.load(std::memory_order_relaxed));
+    result.fd        = currentFd_.load(std::memory_order_relaxed);
+    result.since     = phaseSince_.load(std::memory_order_relaxed);
+    return result;
+}
+
+EventLoop::LoopStats EventLoop::loopStats() const {
+    const int64_t busy  = busyNanos_.load(std::memory_order_relaxed);
+    const int64_t idle  = idleNanos_.load(std::memory_order_relaxed);
+    const int64_t total = busy + idle;
+    return { iterations_.load(std::memory_order_relaxed), Nanoseconds(busy),
+             Nanoseconds(idle),
+             total > 0 ? static_cast<double>(busy) / total : 0.0 };
+}
+
+void EventLoop::setSlowCallbackThreshold(Nanoseconds threshold) {
+    slowCallbackNanos_.store(threshold.count(), std::memory_order_relaxed);
+}
+
+EventLoop::HookId EventLoop::addPrepareHook(LoopHook hook) {
+    return addHook(kPrepare, [hook = std::move(hook)] {
+        hook();
+        return false;
+    });
+}
+
+EventLoop::HookId EventLoop::addCheckHook(LoopHook hook) {
+    return addHook(kCheck, [hook = std::move(hook)] {
+        hook();
+        return false;
+    });
+}
+
+EventLoop::HookId EventLoop::addIdleHook(IdleHook hook) {
+    return addHook(kIdle, std::move(hook));
+}
+
+EventLoop::HookId EventLoop::addHook(HookPhase phase, IdleHook callback) {
+    const HookId id = nextHookId_.fetch_add(1, std::memory_order_relaxed);
+    modifyHooks([this, phase, id, callback = std::move(callback)]() mutable {
+        hooks_[phase].push_back({ id, std::move(callback) });
+    });
+    return id;
+}
+
+void EventLoop::removeHook(HookId id) {
+    modifyHooks([this, id] {
+        for (HookList& hooks : hooks_) {
+            hooks.erase(std::remove_if(hooks.begin(), hooks.end(),
+                                       [id](const Hook& hook) {
+                                           return hook.id == id;
+                                       }),
+                        hooks.end());
+        }
+    });
+}
+
+void EventLoop::modifyHooks(Task&& task) {
+    if (isInLoopThread() && !runningHooks_) {
         task();
     }
     else {
@@ -136,36 +488,47 @@ void EventLoop::runInLoop(Task&& task) {
     }
 }
 
-void EventLoop::queueInLoop(const Task& task) {
-    {
-        std::lock_guard<std::mutex> guard(mutex_);
-        pendingTasks_.push_back(task);
+bool EventLoop::runHooks(HookPhase phase) {
+    beat(kLoopHooks, -1, steadyNanos());
+    runningHooks_ = true;
+    bool more     = false;
+    for (const Hook& hook : hooks_[phase]) {
+        more |= hook.callback();
     }
-    if (!isInLoopThread() || doingPendingTasks_)
-        wakeup();
+    runningHooks_ = false;
+    // prepare / idle 钩子之后回到等待事件
+    if (phase != kCheck) {
+        beat(kPolling, -1, steadyNanos());
+    }
+    return more;
 }
 
-void EventLoop::queueInLoop(Task&& task) {
-    {
-        std::lock_guard<std::mutex> guard(mutex_);
-        pendingTasks_.push_back(std::move(task));
-    }
-    if (!isInLoopThread() || doingPendingTasks_)
-        wakeup();
+void EventLoop::setBulkBudget(size_t maxTasks, Nanoseconds maxTime) {
+    bulkMaxTasks_.store(maxTasks, std::memory_order_relaxed);
+    bulkMaxNanos_.store(maxTime.count(), std::memory_order_relaxed);
 }
 
-void EventLoop::doPendingTasks() {
+EventLoop::LaneStats EventLoop::laneStats(Lane lane) const {
+    const TaskLane& taskLane = lanes_[lane];
+    return { taskLane.depth.load(std::memory_order_relaxed),
+             taskLane.executed.load(std::memory_order_relaxed),
+             Nanoseconds(taskLane.delayNanos.load(std::memory_order_relaxed)),
+             Nanoseconds(
+                 taskLane.maxDelayNanos.load(std::memory_order_relaxed)) };
+}
+
+void EventLoop::queueFlush(Task&& task) {
     assertInLoopThread();
-    std::vector<Task> tasks;
-    {
-        std::lock_guard<std::mutex> guard(mutex_);
-        tasks.swap(pendingTasks_);
-    }
-    doingPendingTasks_ = true;
-    for (Task& task : tasks) {
+    flushTasks_.push_back(std::move(task));
+}
+
+void EventLoop::doFlushTasks() {
+    // flush 过程中可能再次 queueFlush，逐个取出执行
+    for (size_t i = 0; i < flushTasks_.size(); ++i) {
+        Task task = std::move(flushTasks_[i]);
         task();
     }
-    doingPendingTasks_ = false;
+    flushTasks_.clear();
 }
 
 void EventLoop::wakeup() {
@@ -1,20 +1,27 @@
 #ifndef LIBNET_EVENTLOOP_H
 #define LIBNET_EVENTLOOP_H
 
+#include "core/BufferPool.h"
+#include "core/TimerId.h"
 #include "core/TimerQueue.h"
+#include "utils/Histogram.h"
+#include "utils/MpscQueue.h"
 #include "utils/noncopyable.h"
 #include <any>
 #include <atomic>
 #include <cstddef>
-#include <mutex>
+#include <pthread.h>
 #include <sys/types.h>
 #include <thread>
 #include <vector>
 
 namespace libnet {
 
-class EPoller;
+class Poller;
 class Channel;
+class IdleWheel;
+class ZeroCopyGraveyard;
+class LoopWatchdog;
 
 class EventLoop : noncopyable
 {
@@ -25,10 +32,21 @@ public:
     void loop();
     void quit();
 
-    void runInLoop(const Task& task);
+    // 每轮先执行完 kUrgent 中的 task，再在预算内执行 kBulk 中的 task，
+    // 超出预算的留到下一轮，批量任务不会拖慢连接建立、回复等紧急任务
+    enum Lane
+    {
+        kUrgent = 0,
+        kBulk,
+        kNumLanes
+    };
+
     void runInLoop(Task&& task);
-    void queueInLoop(const Task& task);
-    void queueInLoop(Task&& task);
+    void queueInLoop(Task&& task) { queueInLoop(std::move(task), kUrgent); }
+    void queueInLoop(Task&& task, Lane lane);
+    // 在本轮事件回调之后、下一次 poll 之前执行，只能在 loop 线程中调用
+    // TcpConnection 用它把一轮回调中的多次 send 合并为一次写出
+    void queueFlush(Task&& task);
 
     void updateChannel(Channel* channel);
     void removeChannel(Channel* channel);
@@ -41,30 +59,245 @@ public:
 
     bool isInLoopThread() const;
 
-    Timer::sptr runAt(Timestamp when, TimerCallback callback);
-    Timer::sptr runAfter(Nanoseconds interval, TimerCallback callback);
-    Timer::sptr runEvery(Nanoseconds interval, TimerCallback callback);
-    void        cancelTimer(Timer::sptr timer);
+    TimerId runAt(Timestamp when, TimerCallback callback);
+    TimerId runAfter(Nanoseconds interval, TimerCallback callback);
+    TimerId runEvery(Nanoseconds interval, TimerCallback callback);
+    // 定时器已到期 (非重复) 或已取消时什么也不做
+    void    cancelTimer(TimerId timerId);
+    // 修改到期时间 (重新计时)，在自己的回调中调用时会重新加入
+    void    updateTimer(TimerId timerId, Timestamp when);
+    // 尚未释放的定时器数。thread safe
+    size_t  numTimers() const { return timerQueue_.size(); }
 
     void wakeup();
 
+    // 本 loop 的 Buffer 内存池
+    const BufferPool::ptr& bufferPool() const { return bufferPool_; }
+    // 本 loop 的空闲超时检测，只能在 loop 线程中使用
+    IdleWheel&             idleWheel() { return *idleWheel_; }
+    // 收留关闭时仍有零拷贝数据在途的连接，只能在 loop 线程中使用
+    ZeroCopyGraveyard&     zeroCopyGraveyard() { return *zeroCopyGraveyard_; }
+    // 本轮 poll 返回的时刻 (steady_clock 纳秒)，在 loop 线程中代替读时钟
+    int64_t                pollReturnTime() const { return pollReturnTime_; }
+
+    // 本 loop 使用的 Poller，可查看系统调用统计；
+    // 完成模式的操作 (见 Poller::completionMode) 只能在 loop 线程中提交
+    const Poller* poller() const { return poller_.get(); }
+    Poller*       poller() { return poller_.get(); }
+
+    // 忙轮询 : 阻塞等待之前先以 0 超时反复 poll，最多自旋 maxSpin，0 表示关闭
+    // 实际的自旋预算按事件到达间隔的 EWMA 自适应调整，间隔远大于 maxSpin 时
+    // 不再自旋。thread safe
+    void setBusyPoll(Nanoseconds maxSpin);
+
+    // 关闭后定时器不再经过 timerfd，最早的到期时间直接作为 poll 的超时
+    // (epoll_pwait2 精确到纳秒)，省去 timerfd_settime 与 read。thread safe
+    void setUseTimerfd(bool on);
+
+    // resolution > 0 时定时器改用该精度的分层时间轮 (加入、取消、修改均为
+    // O(1)，适合大量频繁重置的超时)，0 时改用小根堆。已有的定时器随之迁移。
+    // 默认见 TimerStore::newDefaultTimerStore。thread safe
+    void setTimingWheel(Nanoseconds resolution);
+
+    // 每轮最多执行 maxTasks 个 / maxTime 时长的 kBulk task，0 表示不限制；
+    // 有紧急 task 到达时也会提前让出。thread safe
+    static const size_t kDefaultBulkTasks = 256;
+    void setBulkBudget(size_t maxTasks, Nanoseconds maxTime = 1ms);
+
+    struct LaneStats
+    {
+        size_t      depth;     // 队列中尚未执行的 task 数
+        uint64_t    executed;  // 已执行的 task 数
+        Nanoseconds delay;     // 已执行 task 的排队时间之和
+        Nanoseconds maxDelay;  // 最长的排队时间
+    };
+    // thread safe
+    LaneStats laneStats(Lane lane) const;
+
+    // 循环各阶段的钩子，类似 libuv 的 prepare / check / idle
+    //   prepare : 每轮 poll 之前
+    //   check   : 每轮 I/O 事件、定时器与 pending task 处理完之后，适合一次性
+    //             写出攒下的数据、汇总指标、延迟释放等，其中的 send 随后合并写出
+    //   idle    : 没有就绪事件、将要阻塞等待之前；返回 true 表示还有后台工作，
+    //             loop 不阻塞，下一轮仍然空闲时再次调用
+    // 没有注册钩子时没有额外开销。thread safe
+    using HookId = uint64_t;
+    HookId addPrepareHook(LoopHook hook);
+    HookId addCheckHook(LoopHook hook);
+    HookId addIdleHook(IdleHook hook);
+    void   removeHook(HookId id);
+
+    struct BusyPollStats
+    {
+        Nanoseconds spinTime;   // 自旋 poll 花费的时间
+        Nanoseconds sleepTime;  // 阻塞等待的时间
+        uint64_t    spinHits;   // 自旋期间等到事件的次数
+        uint64_t    sleeps;     // 自旋落空后阻塞等待的次数
+        Nanoseconds budget;     // 当前的自旋预算
+    };
+    // thread safe
+    BusyPollStats busyPollStats() const;
+
+    // 自我剖析 : loop 线程始终记录，任意线程可无锁读取，时间单位为纳秒
+    //   pollWait      : 每轮等待事件的时间 (含自旋与 prepare / idle 钩子)
+    //   dispatch      : 每次 Channel::handleEvents 的耗时
+    //   taskDelay     : pending task 从入队到开始执行的时间
+    //   eventsPerPoll : 每轮的就绪事件数
+    const Histogram& pollWaitHistogram() const { return pollWait_; }
+    const Histogram& dispatchHistogram() const { return dispatch_; }
+    const Histogram& taskDelayHistogram() const { return taskDelay_; }
+    const Histogram& eventsPerPollHistogram() const { return eventsPerPoll_; }
+
+    struct LoopStats
+    {
+        uint64_t    iterations;
+        Nanoseconds busyTime;   // 处理事件、定时器、task 的时间
+        Nanoseconds idleTime;   // 等待事件的时间
+        double      busyRatio;  // busyTime / (busyTime + idleTime)
+    };
+    // thread safe
+    LoopStats loopStats() const;
+
+    // 单个 I/O 回调、定时器批次或 task 超过 threshold 时以 LOG_WARN 记录 fd 与
+    // 回调类型 (I/O 回调为实际调用的 read / write / close / error)，0 表示关闭。
+    // thread safe
+    static constexpr Nanoseconds kDefaultSlowCallbackThreshold = 100ms;
+    void setSlowCallbackThreshold(Nanoseconds threshold);
+
+    // loop 当前所处的阶段，每进入一个阶段/回调都会发布一次心跳，
+    // 供 LoopWatchdog 检测卡住的 loop
+    enum Phase
+    {
+        kPolling = 0,  // 等待事件，阻塞在此不算卡住
+        kIoCallback,
+        kTimers,
+        kPendingTasks,
+        kLoopHooks,
+    };
+    static const char* phaseName(Phase phase);
+
+    struct Progress
+    {
+        uint64_t heartbeat;  // 每次发布递增
+        Phase    phase;
+        int      fd;         // kIoCallback 时为正在处理的 fd，否则为 -1
+        int64_t  since;      // 进入该阶段的时间 (steady_clock 纳秒)
+    };
+    // thread safe
+    Progress  progress() const;
+    pthread_t threadHandle() const { return threadHandle_; }
+
 private:
+    friend class LoopWatchdog;
+
     using ChannelList = std::vector<Channel*>;
     using TaskList    = std::vector<Task>;
 
+    // 排队中的 task 及其入队时间 (steady_clock 纳秒)
+    struct PendingTask
+    {
+        Task    task;
+        int64_t queuedAt = 0;
+    };
+
+    struct TaskLane
+    {
+        TaskLane() : depth(0), executed(0), delayNanos(0), maxDelayNanos(0) {}
+
+        MpscQueue<PendingTask, 256> queue;
+        std::atomic<size_t>         depth;
+        std::atomic<uint64_t>       executed;
+        std::atomic<int64_t>        delayNanos;
+        std::atomic<int64_t>        maxDelayNanos;
+    };
+
+    enum HookPhase
+    {
+        kPrepare = 0,
+        kCheck,
+        kIdle,
+        kNumPhases
+    };
+
+    struct Hook
+    {
+        HookId   id;
+        IdleHook callback;
+    };
+    using HookList = std::vector<Hook>;
+
+    HookId addHook(HookPhase phase, IdleHook callback);
+    // 在 loop 线程中修改钩子列表，正在执行钩子时推迟到 pending task 中
+    void modifyHooks(Task&& task);
+    // 返回是否有钩子要求继续执行
+    bool runHooks(HookPhase phase);
+
+    void pollEvents();
     void doPendingTasks();
+    // 返回 task 执行完的时间
+    int64_t runPendingTask(TaskLane& lane, PendingTask& pending, int64_t now);
+    void    beat(Phase phase, int fd, int64_t now) {
+        phase_.store(phase, std::memory_order_relaxed);
+        currentFd_.store(fd, std::memory_order_relaxed);
+        phaseSince_.store(now, std::memory_order_relaxed);
+        heartbeat_.store(heartbeat_.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+    }
+    // handlers 为 Channel::handleEvents 的返回值
+    void    reportSlowCallback(const char* what,
+                               int         fd,
+                               int         handlers,
+                               int64_t     nanos);
+    void doFlushTasks();
     void handleRead();
 
     const std::thread::id    tid_;
     std::atomic<bool>        quit_;
-    std::unique_ptr<EPoller> poller_;
+    std::unique_ptr<Poller>  poller_;
+    BufferPool::ptr          bufferPool_;
     ChannelList              activeChannels_;
     TimerQueue               timerQueue_;
+    int64_t                  pollReturnTime_;
+    std::unique_ptr<IdleWheel> idleWheel_;  // 先于 timerQueue_ 销毁
+    std::unique_ptr<ZeroCopyGraveyard> zeroCopyGraveyard_;  // 同上
     bool                     doingPendingTasks_;
-    TaskList                 pendingTasks_;
+    TaskLane                 lanes_[kNumLanes];
+    TaskList                 flushTasks_;
     const int                wakeupFd_;
     std::unique_ptr<Channel> wakeupChannel_;
-    mutable std::mutex       mutex_;
+    // 已写过 eventfd 而 loop 尚未开始处理 pending task，
+    // 期间其他线程的 queueInLoop 不必再次唤醒
+    std::atomic_bool         wakeupPending_;
+    std::atomic<size_t>      bulkMaxTasks_;
+    std::atomic<int64_t>     bulkMaxNanos_;
+    HookList                 hooks_[kNumPhases];
+    bool                     runningHooks_;
+    std::atomic<HookId>      nextHookId_;
+
+    std::atomic<int64_t>  busyPollMax_;     // 纳秒
+    std::atomic<int64_t>  busyPollBudget_;  // 纳秒，只由 loop 线程调整
+    int64_t               idleGapEwma_;     // 纳秒
+    std::atomic<int64_t>  spinNanos_;
+    std::atomic<int64_t>  sleepNanos_;
+    std::atomic<uint64_t> spinHits_;
+    std::atomic<uint64_t> sleeps_;
+
+    Histogram             pollWait_;
+    Histogram             dispatch_;
+    Histogram             taskDelay_;
+    Histogram             eventsPerPoll_;
+    std::atomic<uint64_t> iterations_;
+    std::atomic<int64_t>  busyNanos_;
+    std::atomic<int64_t>  idleNanos_;
+    std::atomic<int64_t>  slowCallbackNanos_;
+
+    const pthread_t              threadHandle_;
+    std::atomic<uint64_t>        heartbeat_;
+    std::atomic<int>             phase_;
+    std::atomic<int>             currentFd_;
+    std::atomic<int64_t>         phaseSince_;
+    // 监视本 loop 的 watchdog，loop 析构时从中注销
+    std::atomic<LoopWatchdog*>   watchdog_;
 };
 
 }  // namespace libnet
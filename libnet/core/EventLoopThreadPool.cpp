@@ -35,3 +35,12 @@ EventLoop* EventLoopThreadPool::getNextLoop() {
     }
     return loop;
 }
+
+std::vector<EventLoop*> EventLoopThreadPool::getAllLoops() {
+    baseLoop_->assertInLoopThread();
+    assert(started_);
+    if (loops_.empty()) {
+        return std::vector<EventLoop*>(1, baseLoop_);
+    }
+    return loops_;
+}
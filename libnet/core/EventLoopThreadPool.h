@@ -22,7 +22,8 @@ public:
 
     void start();
 
-    EventLoop* getNextLoop();
+    EventLoop*              getNextLoop();
+    std::vector<EventLoop*> getAllLoops();
     size_t     numThreads() const { return numThreads_; }
 
 private:
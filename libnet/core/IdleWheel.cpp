@@ -0,0 +1,125 @@
+#include "core/IdleWheel.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace libnet;
+
+IdleWheel::IdleWheel(EventLoop* loop)
+    : loop_(loop),
+      base_(loop->pollReturnTime()),
+      current_(0),
+      size_(0),
+      timer_(),
+      buckets_() {}
+
+IdleWheel::~IdleWheel() {
+    for (Bucket& bucket : buckets_) {
+        Entry* entry = bucket.head;
+        while (entry != nullptr) {
+            Entry* next    = entry->next_;
+            entry->wheel_  = nullptr;
+            entry->prev_   = nullptr;
+            entry->next_   = nullptr;
+            entry->bucket_ = -1;
+            entry          = next;
+        }
+        bucket = Bucket();
+    }
+}
+
+void IdleWheel::add(Entry* entry, Nanoseconds timeout) {
+    loop_->assertInLoopThread();
+    assert(!entry->linked());
+    const int64_t now = loop_->pollReturnTime();
+    if (size_ == 0) {
+        // 停止期间的空桶不必处理
+        current_ = tickOf(now);
+        timer_   = loop_->runEvery(kTick, [this] { onTick(); });
+    }
+    entry->wheel_      = this;
+    entry->lastActive_ = now;
+    entry->timeout_    = std::max<int64_t>(timeout.count(), 1);
+    link(entry);
+    ++size_;
+}
+
+void IdleWheel::remove(Entry* entry) {
+    if (entry->wheel_ != this) {
+        return;
+    }
+    unlink(entry);
+    entry->wheel_ = nullptr;
+    --size_;
+    if (size_ == 0 && timer_.valid()) {
+        loop_->cancelTimer(timer_);
+        timer_ = TimerId();
+    }
+}
+
+int64_t IdleWheel::tickOf(int64_t nanos) const {
+    return (nanos - base_) / kTick.count();
+}
+
+void IdleWheel::link(Entry* entry) {
+    const int64_t deadline = entry->lastActive_ + entry->timeout_ - base_;
+    int64_t       tick     = (deadline + kTick.count() - 1) / kTick.count();
+    tick = std::min(std::max(tick, current_ + 1), current_ + kNumBuckets - 1);
+
+    const int index = static_cast<int>(tick % kNumBuckets);
+    Bucket&   list  = buckets_[index];
+    entry->prev_    = list.tail;
+    entry->next_    = nullptr;
+    if (list.tail != nullptr) {
+        list.tail->next_ = entry;
+    }
+    else {
+        list.head = entry;
+    }
+    list.tail      = entry;
+    entry->bucket_ = index;
+}
+
+void IdleWheel::unlink(Entry* entry) {
+    assert(entry->bucket_ >= 0);
+    Bucket& list = buckets_[entry->bucket_];
+    if (entry->prev_ != nullptr) {
+        entry->prev_->next_ = entry->next_;
+    }
+    else {
+        list.head = entry->next_;
+    }
+    if (entry->next_ != nullptr) {
+        entry->next_->prev_ = entry->prev_;
+    }
+    else {
+        list.tail = entry->prev_;
+    }
+    entry->prev_   = nullptr;
+    entry->next_   = nullptr;
+    entry->bucket_ = -1;
+}
+
+void IdleWheel::onTick() {
+    const int64_t now    = loop_->pollReturnTime();
+    const int64_t target = tickOf(now);
+    // 落后超过一圈时每个桶只需处理一次
+    for (int64_t tick = std::max(current_ + 1, target - kNumBuckets + 1);
+         tick <= target; ++tick) {
+        current_       = tick;
+        Bucket& bucket = buckets_[tick % kNumBuckets];
+        // 重新入桶的条目都落在之后的桶中；回调可能移除任意条目，每次只取表头
+        while (bucket.head != nullptr) {
+            Entry* entry = bucket.head;
+            unlink(entry);
+            if (now - entry->lastActive_ < entry->timeout_) {
+                link(entry);
+                continue;
+            }
+            entry->lastActive_ = now;
+            link(entry);
+            entry->onIdle_();
+        }
+    }
+    current_ = std::max(current_, target);
+}
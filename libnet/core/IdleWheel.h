@@ -0,0 +1,100 @@
+#ifndef LIBNET_IDLEWHEEL_H
+#define LIBNET_IDLEWHEEL_H
+
+#include "core/EventLoop.h"
+#include "core/TimerId.h"
+#include "core/Timestamp.h"
+#include "utils/noncopyable.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace libnet {
+
+// 每个 loop 一个的空闲超时检测，用于连接的 idle timeout
+// 条目嵌入在使用者 (TcpConnection) 中，按截止时间挂在 kNumBuckets 个桶组成的
+// 环形侵入式链表上。有活动时 touch 只记下本轮 poll 返回的时刻，不移动链表；
+// 桶到期时逐个检查其中的条目 : 仍在超时内的按最近一次活动重新入桶，
+// 真正空闲的重新计时后回调 onIdle。超出环的截止时间先放在最远的桶，到时再挪。
+// 空闲时间以 poll 返回的时刻计，不会提前触发，最多推迟约一个 kTick。
+// 有条目时才以 runEvery 驱动。只能在 loop 线程中使用
+class IdleWheel : noncopyable
+{
+public:
+    static constexpr Nanoseconds kTick = 250ms;
+
+    class Entry : noncopyable
+    {
+    public:
+        // 回调中可以 remove 任意条目 (包括自己)
+        using Callback = std::function<void()>;
+
+        explicit Entry(Callback onIdle)
+            : wheel_(nullptr),
+              prev_(nullptr),
+              next_(nullptr),
+              bucket_(-1),
+              lastActive_(0),
+              timeout_(0),
+              onIdle_(std::move(onIdle)) {}
+
+        bool linked() const { return wheel_ != nullptr; }
+
+        // 记录一次活动，未加入时什么也不做
+        inline void touch();
+
+    private:
+        friend class IdleWheel;
+
+        IdleWheel* wheel_;
+        Entry*     prev_;
+        Entry*     next_;
+        int        bucket_;
+        int64_t    lastActive_;  // steady_clock 纳秒
+        int64_t    timeout_;     // 纳秒
+        Callback   onIdle_;
+    };
+
+    explicit IdleWheel(EventLoop* loop);
+    ~IdleWheel();
+
+    // timeout 内没有 touch 即回调 onIdle，entry 不能已在其中
+    void add(Entry* entry, Nanoseconds timeout);
+    // 不在其中时什么也不做
+    void remove(Entry* entry);
+
+    size_t size() const { return size_; }
+
+private:
+    static const int kNumBuckets = 64;
+
+    struct Bucket
+    {
+        Entry* head = nullptr;
+        Entry* tail = nullptr;
+    };
+
+    int64_t tickOf(int64_t nanos) const;
+    // 按 lastActive_ + timeout_ 入桶，限制在 (current_, current_ + kNumBuckets) 内
+    void    link(Entry* entry);
+    void    unlink(Entry* entry);
+    void    onTick();
+
+    EventLoop*    loop_;
+    const int64_t base_;
+    int64_t       current_;  // 最近处理过的 tick
+    size_t        size_;
+    TimerId       timer_;
+    Bucket        buckets_[kNumBuckets];
+};
+
+inline void IdleWheel::Entry::touch() {
+    if (wheel_ != nullptr) {
+        lastActive_ = wheel_->loop_->pollReturnTime();
+    }
+}
+
+}  // namespace libnet
+
+#endif  // LIBNET_IDLEWHEEL_H
@@ -0,0 +1,271 @@
+#include "core/LoopWatchdog.h"
+#include "logger/Logger.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <execinfo.h>
+#include <mutex>
+#include <pthread.h>
+
+using namespace libnet;
+
+namespace {
+
+const int kMaxFrames = 64;
+
+// 信号处理函数是进程级的，所有 watchdog 共用一个槽，采集时持有 g_backtraceMutex。
+// 每次请求分配一个序号并随信号 (pthread_sigqueue) 送达，处理函数只有在序号
+// 与 pending 相同时才写入 : 超时后才到达的信号、其他来源的同一信号都被忽略
+struct BacktraceSlot
+{
+    std::atomic<uint32_t> pending{ 0 };  // 等待采集的序号，0 表示没有
+    std::atomic<uint32_t> done{ 0 };     // 已写入 frames 的序号
+    void*                 frames[kMaxFrames];
+    int                   depth = 0;
+};
+
+std::mutex    g_backtraceMutex;
+uint32_t      g_backtraceSeq = 0;
+BacktraceSlot g_backtraceSlot;
+
+void backtraceHandler(int, siginfo_t* info, void*) {
+    uint32_t seq = static_cast<uint32_t>(info->si_value.sival_int);
+    if (seq == 0 ||
+        !g_backtraceSlot.pending.compare_exchange_strong(seq, 0)) {
+        return;
+    }
+    const int savedErrno  = errno;
+    g_backtraceSlot.depth = ::backtrace(g_backtraceSlot.frames, kMaxFrames);
+    g_backtraceSlot.done.store(seq, std::memory_order_release);
+    errno = savedErrno;
+}
+
+int64_t steadyNanos() {
+    return std::chrono::duration_cast<Nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void defaultStallCallback(const LoopWatchdog::StallInfo& info) {
+    LOG_ERROR << "EventLoop " << info.loop << " stalled in "
+              << EventLoop::phaseName(info.phase)
+              << (info.fd >= 0 ? " fd=" + std::to_string(info.fd) : "")
+              << " for " << info.stuckFor.count() / 1000000 << "ms";
+    for (const std::string& frame : info.backtrace) {
+        LOG_ERROR << "    " << frame;
+    }
+}
+
+}  // anonymous namespace
+
+LoopWatchdog::LoopWatchdog(Nanoseconds threshold, Nanoseconds interval)
+    : threshold_(threshold),
+      interval_(interval),
+      backtraceSignal_(0),
+      stallCallback_(defaultStallCallback),
+      thread_(),
+      running_(false),
+      mutex_(),
+      cond_(),
+      entries_(),
+      totalStalls_(0) {}
+
+LoopWatchdog::~LoopWatchdog() {
+    stop();
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (Entry& entry : entries_) {
+        entry.loop->watchdog_.store(nullptr, std::memory_order_release);
+    }
+}
+
+void LoopWatchdog::start() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!running_) {
+        running_ = true;
+        thread_  = std::make_unique<std::thread>([this] { threadFunc(); });
+    }
+}
+
+void LoopWatchdog::stop() {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cond_.notify_all();
+    thread_->join();
+    thread_.reset();
+}
+
+void LoopWatchdog::watch(EventLoop* loop) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    LoopWatchdog* expected = nullptr;
+    if (!loop->watchdog_.compare_exchange_strong(expected, this)) {
+        if (expected != this) {
+            LOG_ERROR << "LoopWatchdog::watch() EventLoop " << loop
+                      << " is already watched by another watchdog";
+        }
+        return;
+    }
+    entries_.push_back(
+        { loop, loop->progress().heartbeat, false, 0, Nanoseconds::zero() });
+}
+
+void LoopWatchdog::unwatch(EventLoop* loop) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [loop](const Entry& entry) {
+                               return entry.loop == loop;
+                           });
+    if (it != entries_.end()) {
+        entries_.erase(it);
+        loop->watchdog_.store(nullptr, std::memory_order_release);
+    }
+}
+
+void LoopWatchdog::setStallCallback(const StallCallback& callback) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stallCallback_ = callback;
+}
+
+void LoopWatchdog::setBacktraceSignal(int signo) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (signo > 0) {
+        // backtrace 首次调用会加载 libgcc，先在这里完成，信号处理函数中才安全
+        void* frames[1];
+        ::backtrace(frames, 1);
+
+        struct sigaction action = {};
+        action.sa_sigaction     = backtraceHandler;
+        action.sa_flags         = SA_RESTART | SA_SIGINFO;
+        ::sigemptyset(&action.sa_mask);
+        if (::sigaction(signo, &action, nullptr) < 0) {
+            LOG_SYSERR << "LoopWatchdog::setBacktraceSignal() sigaction";
+            return;
+        }
+    }
+    backtraceSignal_ = signo;
+}
+
+LoopWatchdog::StallStats LoopWatchdog::stallStats(const EventLoop* loop) const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (const Entry& entry : entries_) {
+        if (entry.loop == loop) {
+            return { entry.stalls, entry.longest, entry.stalled };
+        }
+    }
+    return { 0, Nanoseconds::zero(), false };
+}
+
+void LoopWatchdog::threadFunc() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<StallInfo>       stalls;
+    while (running_) {
+        cond_.wait_for(lock, interval_);
+        if (!running_) {
+            break;
+        }
+        check(stalls);
+        if (!stalls.empty()) {
+            // 回调在锁外执行，其中可以 watch / unwatch 或查询统计
+            const StallCallback callback = stallCallback_;
+            lock.unlock();
+            for (const StallInfo& info : stalls) {
+                callback(info);
+            }
+            stalls.clear();
+            lock.lock();
+        }
+    }
+}
+
+// 持有 mutex_ 时调用，新检测到的卡顿追加到 stalls
+void LoopWatchdog::check(std::vector<StallInfo>& stalls) {
+    const int64_t now = steadyNanos();
+    for (Entry& entry : entries_) {
+        const EventLoop::Progress progress = entry.loop->progress();
+        if (progress.heartbeat != entry.lastBeat) {
+            if (entry.stalled) {
+                LOG_WARN << "EventLoop " << entry.loop
+                         << " recovered from a stall of at least "
+                         << entry.longest.count() / 1000000 << "ms";
+                entry.stalled = false;
+            }
+            entry.lastBeat = progress.heartbeat;
+            continue;
+        }
+        if (progress.phase == EventLoop::kPolling) {
+            continue;
+        }
+        const Nanoseconds stuckFor(now - progress.since);
+        if (stuckFor < threshold_) {
+            continue;
+        }
+        entry.longest = std::max(entry.longest, stuckFor);
+        if (entry.stalled) {
+            continue;
+        }
+        entry.stalled = true;
+        ++entry.stalls;
+        totalStalls_.fetch_add(1, std::memory_order_relaxed);
+
+        StallInfo info{ entry.loop, progress.phase, progress.fd, stuckFor, {} };
+        // loop 在持有 mutex_ 期间不会析构，调用栈须在这里采集
+        if (backtraceSignal_ > 0) {
+            info.backtrace = captureBacktrace(entry.loop);
+        }
+        stalls.push_back(std::move(info));
+    }
+}
+
+std::vector<std::string> LoopWatchdog::captureBacktrace(EventLoop* loop) {
+    std::vector<std::string>    result;
+    std::lock_guard<std::mutex> guard(g_backtraceMutex);
+    if (++g_backtraceSeq == 0) {
+        ++g_backtraceSeq;
+    }
+    const uint32_t seq = g_backtraceSeq;
+    g_backtraceSlot.pending.store(seq, std::memory_order_release);
+
+    union sigval value;
+    value.sival_int = static_cast<int>(seq);
+    const int err =
+        ::pthread_sigqueue(loop->threadHandle(), backtraceSignal_, value);
+    if (err != 0) {
+        g_backtraceSlot.pending.store(0, std::memory_order_relaxed);
+        errno = err;
+        LOG_SYSERR << "LoopWatchdog::captureBacktrace() pthread_sigqueue";
+        return result;
+    }
+    // 最多等待 100ms；超时后撤回请求，若处理函数已经开始写入则等它写完
+    bool done = false;
+    for (int i = 0; i < 100 && !done; ++i) {
+        std::this_thread::sleep_for(1ms);
+        done = g_backtraceSlot.done.load(std::memory_order_acquire) == seq;
+    }
+    if (!done) {
+        uint32_t expected = seq;
+        if (g_backtraceSlot.pending.compare_exchange_strong(expected, 0)) {
+            return result;
+        }
+        while (g_backtraceSlot.done.load(std::memory_order_acquire) != seq) {
+            std::this_thread::yield();
+        }
+    }
+
+    char** symbols =
+        ::backtrace_symbols(g_backtraceSlot.frames, g_backtraceSlot.depth);
+    if (symbols != nullptr) {
+        // 跳过信号处理函数与信号跳板
+        for (int j = 2; j < g_backtraceSlot.depth; ++j) {
+            result.emplace_back(symbols[j]);
+        }
+        ::free(symbols);
+    }
+    return result;
+}
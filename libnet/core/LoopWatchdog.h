@@ -0,0 +1,99 @@
+#ifndef LIBNET_LOOPWATCHDOG_H
+#define LIBNET_LOOPWATCHDOG_H
+
+#include "core/EventLoop.h"
+#include "core/Timestamp.h"
+#include "utils/noncopyable.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace libnet {
+
+// 检测卡住的 EventLoop
+// 后台线程每隔 interval 检查一次各 loop 发布的心跳，loop 停留在同一个
+// 回调/阶段 (等待事件除外) 超过 threshold 即报告一次卡顿，恢复后再报告持续时间。
+// 开启 setBacktraceSignal 后，以信号打断卡住的线程并采集其调用栈。
+// 被监视的 loop 析构时自动注销；watchdog 本身须比它监视的 loop 活得更久
+class LoopWatchdog : noncopyable
+{
+public:
+    struct StallInfo
+    {
+        EventLoop*        loop;
+        EventLoop::Phase  phase;
+        int               fd;         // 卡在 I/O 回调时的 fd，否则为 -1
+        Nanoseconds       stuckFor;
+        std::vector<std::string> backtrace;  // 未开启或采集失败时为空
+    };
+    // 在 watchdog 线程中调用，不持有 watchdog 的锁；
+    // 此时 info.loop 可能已经析构，只能用作标识
+    using StallCallback = std::function<void(const StallInfo&)>;
+
+    struct StallStats
+    {
+        uint64_t    stalls;   // 检测到的卡顿次数
+        Nanoseconds longest;  // 观察到的最长卡顿
+        bool        stalled;  // 当前是否卡住
+    };
+
+    explicit LoopWatchdog(Nanoseconds threshold = 1s,
+                          Nanoseconds interval  = 100ms);
+    ~LoopWatchdog();
+
+    void start();
+    void stop();
+
+    // thread safe
+    void watch(EventLoop* loop);
+    void unwatch(EventLoop* loop);
+
+    // 默认以 LOG_ERROR 记录
+    void setStallCallback(const StallCallback& callback);
+    // 以 signo (如 SIGUSR2) 采集卡住线程的调用栈，0 表示关闭。
+    // 会为该信号安装进程级的处理函数 (SA_RESTART)，须在 start 之前调用；
+    // 卡在 sleep、poll 等不可重启的系统调用中时，它们会提前返回 EINTR
+    void setBacktraceSignal(int signo);
+
+    // thread safe
+    uint64_t   totalStalls() const {
+        return totalStalls_.load(std::memory_order_relaxed);
+    }
+    StallStats stallStats(const EventLoop* loop) const;
+
+private:
+    struct Entry
+    {
+        EventLoop*  loop;
+        uint64_t    lastBeat;
+        bool        stalled;
+        uint64_t    stalls;
+        Nanoseconds longest;
+    };
+
+    void threadFunc();
+    void check(std::vector<StallInfo>& stalls);
+    std::vector<std::string> captureBacktrace(EventLoop* loop);
+
+    const Nanoseconds            threshold_;
+    const Nanoseconds            interval_;
+    int                          backtraceSignal_;
+    StallCallback                stallCallback_;
+    std::unique_ptr<std::thread> thread_;
+    bool                         running_;
+    mutable std::mutex           mutex_;
+    std::condition_variable      cond_;
+    std::vector<Entry>           entries_;
+    std::atomic<uint64_t>        totalStalls_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_LOOPWATCHDOG_H
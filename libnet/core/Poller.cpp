@@ -0,0 +1,23 @@
+#include "core/Poller.h"
+#include "core/EPoller.h"
+#include "core/UringPoller.h"
+#include "logger/Logger.h"
+
+#include <cstdlib>
+
+using namespace libnet;
+
+const size_t Poller::kRecvBlockSize;
+const size_t Poller::kRecvHeadroom;
+
+Poller::ptr Poller::newDefaultPoller(EventLoop* loop) {
+    if (::getenv("LIBNET_USE_URING") != nullptr) {
+        auto poller = std::make_unique<UringPoller>(loop);
+        if (poller->ok()) {
+            return poller;
+        }
+        LOG_WARN << "Poller::newDefaultPoller() io_uring unavailable, "
+                 << "fall back to epoll";
+    }
+    return std::make_unique<EPoller>(loop);
+}
@@ -0,0 +1,109 @@
+#ifndef LIBNET_POLLER_H
+#define LIBNET_POLLER_H
+
+#include "core/Timestamp.h"
+#include "utils/noncopyable.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct msghdr;
+
+namespace libnet {
+
+class EventLoop;
+class Channel;
+
+// I/O 多路复用的抽象，每个 EventLoop 一个，只能在 loop 线程中使用
+// EPoller 为默认实现；设置环境变量 LIBNET_USE_URING 时使用 UringPoller，
+// 它另外支持完成模式 : 由内核完成 accept/recv/send，结果通过
+// CompletionHandler 交回，与 channel 的回调在同一轮中分发
+class Poller : noncopyable
+{
+public:
+    using ChannelList = std::vector<Channel*>;
+    using ptr         = std::unique_ptr<Poller>;
+    using OpId        = uint64_t;  // 完成模式下的一次操作，0 表示无效
+
+    struct Stats
+    {
+        uint64_t pollCalls;    // 等待事件的系统调用次数
+        uint64_t ctlCalls;     // 仅为修改关注事件而进行的系统调用次数
+        uint64_t ctlAvoided;   // 合并或相互抵消而省去的修改次数
+        uint64_t completions;  // 完成模式送达的结果数，各省去一次读写系统调用
+    };
+
+    // 完成模式下接收数据的缓冲区由 Poller 提供 : 共 kRecvBlockSize 字节，
+    // 数据从 block + kRecvHeadroom 开始，整个 block 在回调返回前都可以使用
+    static const size_t kRecvBlockSize = 64 * 1024;
+    static const size_t kRecvHeadroom  = 8;
+
+    class CompletionHandler
+    {
+    public:
+        virtual ~CompletionHandler() = default;
+
+        // res 为新连接的 fd 或 -errno；more 为 false 时这次 accept 已结束
+        virtual void handleAcceptComplete(int /*res*/, bool /*more*/) {}
+        // res 为收到的字节数 (数据在 block 中)、0 (对端关闭) 或 -errno；
+        // nonEmpty 表示 socket 中还有数据，随后的结果会继续送达
+        virtual void handleRecvComplete(int /*res*/, char* /*block*/,
+                                        bool /*more*/, bool /*nonEmpty*/) {}
+        // res 为写出的字节数或 -errno
+        virtual void handleSendComplete(int /*res*/) {}
+    };
+
+    explicit Poller(EventLoop* loop) : loop_(loop), stats_() {}
+    virtual ~Poller() = default;
+
+    static ptr newDefaultPoller(EventLoop* loop);
+
+    // timeout 小于 0 表示一直等待
+    virtual void poll(ChannelList& activeChannels,
+                      Nanoseconds  timeout = Nanoseconds(-1)) = 0;
+    // 根据 channel->events() 添加、修改或删除关注的事件
+    virtual void updateChannel(Channel* channel) = 0;
+
+    virtual const char* name() const = 0;
+
+    // 是否支持完成模式，不支持时以下操作都返回 0
+    virtual bool completionMode() const { return false; }
+
+    // 以下操作的结果一直送达到 more 为 false 的最后一个为止，在此之前
+    // Poller 持有 holder，handler 不会被销毁
+    // 多次触发的 accept，新连接为非阻塞、close-on-exec
+    virtual OpId acceptMultishot(int /*fd*/,
+                                 CompletionHandler* /*handler*/,
+                                 const std::shared_ptr<void>& /*holder*/) {
+        return 0;
+    }
+    // 多次触发的 recv，数据读入 Poller 提供的缓冲区
+    virtual OpId recvMultishot(int /*fd*/,
+                               CompletionHandler* /*handler*/,
+                               const std::shared_ptr<void>& /*holder*/) {
+        return 0;
+    }
+    // msg 及其指向的 iovec、数据须保持有效直到结果送达
+    virtual OpId sendMsg(int /*fd*/,
+                         const struct msghdr* /*msg*/,
+                         CompletionHandler* /*handler*/,
+                         const std::shared_ptr<void>& /*holder*/) {
+        return 0;
+    }
+    // 取消操作 : 已经完成的结果照常送达，最后一个结果通常为 -ECANCELED
+    virtual void cancel(OpId /*id*/) {}
+    // 取消并不再回调，handler 随后即可销毁；accept 得到的 fd 由 Poller 关闭
+    virtual void abandon(OpId /*id*/) {}
+
+    // not thread safe
+    const Stats& stats() const { return stats_; }
+
+protected:
+    EventLoop* loop_;
+    Stats      stats_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_POLLER_H
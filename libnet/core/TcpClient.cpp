@@ -23,7 +23,7 @@ TcpClient::TcpClient(EventLoop* loop, const InetAddress& peer)
 }
 
 TcpClient::~TcpClient() {
-    if (retryTimer_ != nullptr) {
+    if (retryTimer_.valid()) {
         loop_->cancelTimer(retryTimer_);
     }
 }
@@ -55,11 +55,12 @@ void TcpClient::newConnection(int                connfd,
                               const InetAddress& peer) {
     loop_->assertInLoopThread();
     loop_->cancelTimer(retryTimer_);
-    retryTimer_.reset();
+    retryTimer_ = TimerId();
     connected_ = true;
 
     auto conn =
-        std::make_shared<TcpConnection>(loop_, connfd, local, peer, 10s);
+        std::make_shared<TcpConnection>(loop_, connfd, local, peer,
+                                        Nanoseconds::zero());
     connection_ = conn;
     conn->setConnectionCallback(connectionCallback_);
     conn->setMessageCallback(messageCallback_);
@@ -5,7 +5,7 @@
 #include "core/Channel.h"
 #include "core/Connector.h"
 #include "core/InetAddress.h"
-#include "core/Timer.h"
+#include "core/TimerId.h"
 #include "utils/noncopyable.h"
 #include <memory>
 
@@ -48,7 +48,7 @@ private:
     EventLoop*            loop_;
     bool                  connected_;
     InetAddress           peer_;
-    Timer::sptr           retryTimer_;
+    TimerId               retryTimer_;
     ConnectorPtr          connector_;
     TcpConnectionPtr      connection_;
     ConnectionCallback    connectionCallback_;
@@ -1,13 +1,23 @@
 #include "core/TcpConnection.h"
 #include "core/EventLoop.h"
 #include "core/Timestamp.h"
+#include "core/ZeroCopyGraveyard.h"
 #include "logger/Logger.h"
 
 #include <cassert>
 #include <cerrno>
 #include <cstddef>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#ifndef SO_ZEROCOPY
+#    define SO_ZEROCOPY 60
+#endif
+
 using namespace libnet;
 
 namespace libnet {
@@ -29,6 +39,18 @@ void defaultMessageCallback(const TcpConnectionPtr& conn, Buffer& buffer) {
 
 }  // namespace libnet
 
+namespace {
+
+// sendFile 排队期间持有 dup 出的 fd
+struct FileHandle
+{
+    explicit FileHandle(int f) : fd(f) {}
+    ~FileHandle() { ::close(fd); }
+    int fd;
+};
+
+}  // anonymous namespace
+
 TcpConnection::TcpConnection(EventLoop* loop,
                              int cfd,
                              const InetAddress& local,
@@ -40,9 +62,24 @@ TcpConnection::TcpConnection(EventLoop* loop,
       channel_(std::make_unique<Channel>(loop, cfd)),
       local_(std::make_unique<InetAddress>(local)),
       peer_(std::make_unique<InetAddress>(peer)),
-      inputBuffer_(std::make_unique<Buffer>()),
-      outputBuffer_(std::make_unique<Buffer>()),
-      highWaterMark_(0) {
+      inputBuffer_(loop->bufferPool()),
+      outputBuffer_(loop->bufferPool()),
+      highWaterMark_(0),
+      zeroCopy_(false),
+      idleTimeout_(heartbeat),
+      idleEntry_([this] { this->handleIdle(); }),
+      sendQueueScheduled_(false),
+      flushPending_(false),
+      writeBlocked_(false),
+      directWrites_(0),
+      readCalls_(0),
+      completion_(false),
+      reading_(false),
+      pendingInput_(false),
+      recvOp_(0),
+      sendOp_(0),
+      sendMsg_(),
+      sendIov_() {
     channel_->setReadCallback([this] { this->handleRead(); });
     channel_->setWriteCallback([this] { this->handleWrite(); });
     channel_->setCloseCallback([this] { this->handleClose(); });
@@ -53,7 +90,18 @@ TcpConnection::TcpConnection(EventLoop* loop,
 
 TcpConnection::~TcpConnection() {
     assert(state_ == kDisconnected);
-    ::close(cfd_);
+    if (outputBuffer_.pinnedCount() == 0) {
+        ::close(cfd_);
+    }
+    else {
+        // 在途的零拷贝数据仍会被内核读取，交给 loop 保留到完成通知到达
+        EventLoop* loop = loop_;
+        int        fd   = cfd_;
+        loop_->runInLoop(
+            [loop, fd, pinned = outputBuffer_.takePinned()]() mutable {
+                loop->zeroCopyGraveyard().adopt(fd, std::move(pinned));
+            });
+    }
     LOG_TRACE << "~TcpConnection() " << name() << " fd=" << cfd_;
 }
 
@@ -62,16 +110,43 @@ void TcpConnection::connectionEstablished() {
     assert(old_state == kConnecting);
     (void)old_state;
     channel_->tie(shared_from_this());
-    channel_->enableReading();
+    completion_ = loop_->poller()->completionMode();
+    // 零拷贝的完成通知经由 channel 的 EPOLLERR 到达，完成模式下不使用
+    if (options_.zeroCopyThreshold > 0 && !completion_) {
+        enableZeroCopy();
+    }
+    if (options_.busyPollMicros > 0) {
+        enableBusyPoll();
+    }
+    if (completion_) {
+        // 由 poller 接收数据，channel 只在 sendfile 写满时等待可写
+        options_.edgeTriggered = false;
+        reading_               = true;
+        startRecv();
+    }
+    else if (options_.edgeTriggered) {
+        channel_->setEdgeTriggered(true);
+        channel_->enableAll();
+    }
+    else {
+        channel_->enableReading();
+    }
+    if (idleTimeout_.count() > 0) {
+        loop_->idleWheel().add(&idleEntry_, idleTimeout_);
+    }
 
     connectionCallback_(shared_from_this());
 }
 
 void TcpConnection::connectionDestroyed() {
     loop_->assertInLoopThread();
+    loop_->idleWheel().remove(&idleEntry_);
     if (state_ == kConnected) {
         state_.exchange(kDisconnected);
-        channel_->disableAll();
+        cancelOps();
+        if (channel_->polling()) {
+            channel_->disableAll();
+        }
 
         // connectionCallback_(shared_from_this());
     }
@@ -82,6 +157,8 @@ void TcpConnection::send(const std::string& data) {
 }
 
 // thread-safe send
+// 其他线程的发送先进入无锁的 sendQueue_，每批只调度一次 loop，
+// 由 drainSendQueue 统一追加到输出队列后一次 writev 写出
 void TcpConnection::send(const char* data, size_t len) {
     if (state_ != kConnected) {
         LOG_WARN << "TcpConnection::send() not connected, give up send ";
@@ -91,9 +168,9 @@ void TcpConnection::send(const char* data, size_t len) {
         sendInLoop(data, len);
     }
     else {
-        loop_->queueInLoop([this, str = std::string(data, data + len)] {
-            this->sendInLoop(str);
-        });
+        OutboundMessage message;
+        message.data.assign(data, len);
+        queueSend(std::move(message));
     }
 }
 
@@ -107,9 +184,225 @@ void TcpConnection::send(Buffer& buffer) {
         buffer.retrieveAll();
     }
     else {
-        loop_->queueInLoop([this, str = buffer.retrieveAllAsString()] {
-            this->sendInLoop(str);
-        });
+        OutboundMessage message;
+        takeBuffer(buffer, &message);
+        queueSend(std::move(message));
+    }
+}
+
+void TcpConnection::send(std::string&& data) {
+    if (state_ != kConnected) {
+        LOG_WARN << "TcpConnection::send() not connected, give up send ";
+        return;
+    }
+    if (loop_->isInLoopThread()) {
+        if (data.size() < BufferChain::kMinReferenceSize) {
+            sendInLoop(data.data(), data.size());
+        }
+        else {
+            auto payload = std::make_shared<const std::string>(std::move(data));
+            Chunk chunk{ payload->data(), payload->size(), &payload };
+            sendInLoop(&chunk, 1);
+        }
+    }
+    else {
+        OutboundMessage message;
+        message.data = std::move(data);
+        queueSend(std::move(message));
+    }
+}
+
+void TcpConnection::send(const BufferChain::Payload& payload) {
+    if (state_ != kConnected) {
+        LOG_WARN << "TcpConnection::send() not connected, give up send ";
+        return;
+    }
+    if (loop_->isInLoopThread()) {
+        Chunk chunk{ payload->data(), payload->size(), &payload };
+        sendInLoop(&chunk, 1);
+    }
+    else {
+        OutboundMessage message;
+        message.payload = payload;
+        queueSend(std::move(message));
+    }
+}
+
+void TcpConnection::send(Buffer& header, const BufferChain::Payload& body) {
+    if (!body || body->empty()) {
+        send(header);
+        return;
+    }
+    if (state_ != kConnected) {
+        LOG_WARN << "TcpConnection::send() not connected, give up send ";
+        return;
+    }
+    if (loop_->isInLoopThread()) {
+        Chunk chunks[2] = { { header.peek(), header.readableBytes(), nullptr },
+                            { body->data(), body->size(), &body } };
+        sendInLoop(chunks, 2);
+        header.retrieveAll();
+    }
+    else {
+        // header 与 body 放在同一条消息中，不会被其他线程的发送插入
+        OutboundMessage message;
+        takeBuffer(header, &message);
+        message.payload = body;
+        queueSend(std::move(message));
+    }
+}
+
+void TcpConnection::takeBuffer(Buffer& buffer, OutboundMessage* message) {
+    if (buffer.usesPool()) {
+        // 存储属于调用方 loop 的内存池，可能正借用它的 scratch (如在消息回调中
+        // 转发输入 Buffer)，不能交给本连接的 loop，拷贝一份；
+        // 调用方的 Buffer 保留自己的内存池
+        message->data.assign(buffer.peek(), buffer.readableBytes());
+        buffer.retrieveAll();
+    }
+    else {
+        // 堆上的存储直接接管，调用方得到一个空 Buffer
+        message->buffer = std::move(buffer);
+    }
+}
+
+void TcpConnection::queueSend(OutboundMessage&& message) {
+    sendQueue_.push(std::move(message));
+    // 已经调度过的 drain 尚未开始清空队列时，不必再次唤醒 loop
+    if (!sendQueueScheduled_.exchange(true, std::memory_order_acq_rel)) {
+        loop_->queueInLoop(
+            [conn = shared_from_this()] { conn->drainSendQueue(); });
+    }
+}
+
+void TcpConnection::drainSendQueue() {
+    loop_->assertInLoopThread();
+    // 先清除标志再取数据 : 之后 push 的消息要么在本次被取到，要么重新调度
+    sendQueueScheduled_.store(false, std::memory_order_seq_cst);
+
+    OutboundMessage message;
+    if (state_ == kDisconnected) {
+        while (sendQueue_.pop(message)) {
+        }
+        return;
+    }
+    const size_t oldLen = outputBuffer_.readableBytes();
+    while (sendQueue_.pop(message)) {
+        if (!message.data.empty()) {
+            outputBuffer_.append(std::move(message.data));
+        }
+        const size_t len = message.buffer.readableBytes();
+        if (len >= BufferChain::kMinReferenceSize) {
+            // 由 holder 接管 Buffer，数据不再拷贝
+            auto holder = std::make_shared<Buffer>(std::move(message.buffer));
+            outputBuffer_.append(holder->peek(), len, holder);
+        }
+        else if (len > 0) {
+            outputBuffer_.append(message.buffer.peek(), len);
+            message.buffer.retrieveAll();
+        }
+        if (message.payload && !message.payload->empty()) {
+            outputBuffer_.append(message.payload);
+        }
+        message.payload.reset();
+        if (message.file) {
+            outputBuffer_.appendFile(message.fileFd, message.fileOffset,
+                                     message.fileLength,
+                                     std::move(message.file));
+        }
+    }
+    const size_t newLen = outputBuffer_.readableBytes();
+    if (newLen == oldLen) {
+        return;
+    }
+    checkHighWaterMark(oldLen, newLen);
+    if (options_.deferredFlush) {
+        scheduleFlush();
+    }
+    else {
+        // 整批消息一次 writev
+        flushOutput();
+    }
+}
+
+void TcpConnection::flushOutput() {
+    if (state_ == kDisconnected || waitingWritable() ||
+        outputBuffer_.empty()) {
+        return;  // 等待可写时由 handleWrite 继续写出
+    }
+    if (completion_ && submitSend()) {
+        return;  // 由 handleSendComplete 继续写出
+    }
+    int savedErrno = 0;
+    ssize_t n = outputBuffer_.writeFd(cfd_, &savedErrno);
+    if (n > 0) {
+        idleEntry_.touch();
+    }
+    if (n == -1 && savedErrno != EWOULDBLOCK && savedErrno != EINTR) {
+        errno = savedErrno;
+        LOG_SYSERR << "TcpConnection::flushOutput()";
+        forceCloseInLoop();
+        return;
+    }
+    if (outputBuffer_.empty()) {
+        if (writeCompleteCallback_) {
+            loop_->queueInLoop([this] {
+                this->writeCompleteCallback_(this->shared_from_this());
+            });
+        }
+    }
+    else {
+        waitWritable();
+    }
+}
+
+void TcpConnection::waitWritable() {
+    if (options_.edgeTriggered) {
+        // 写出只在 socket 写满时停下，之后必然有一次可写边沿
+        writeBlocked_ = true;
+    }
+    else if (!channel_->isWriting()) {
+        channel_->enableWriting();
+    }
+}
+
+TcpConnection::OutputWriter TcpConnection::beginWrite(size_t n) {
+    loop_->assertInLoopThread();
+    return OutputWriter(this, outputBuffer_.beginWrite(n), n);
+}
+
+void TcpConnection::commitWrite(size_t len) {
+    loop_->assertInLoopThread();
+    if (state_ == kDisconnected) {
+        LOG_WARN << "TcpConnection::commitWrite() disconnected, give up send";
+        return;
+    }
+    if (len == 0) {
+        return;
+    }
+    const size_t oldLen = outputBuffer_.readableBytes();
+    outputBuffer_.hasWritten(len);
+    checkHighWaterMark(oldLen, oldLen + len);
+    if (options_.deferredFlush) {
+        scheduleFlush();
+    }
+    else {
+        flushOutput();
+    }
+}
+
+void TcpConnection::scheduleFlush() {
+    if (!flushPending_) {
+        flushPending_ = true;
+        loop_->queueFlush([conn = shared_from_this()] { conn->handleFlush(); });
+    }
+}
+
+void TcpConnection::handleFlush() {
+    flushPending_ = false;
+    flushOutput();
+    if (state_ == kDisconnecting) {
+        shutdownInLoop();
     }
 }
 
@@ -118,31 +411,62 @@ void TcpConnection::sendInLoop(const std::string& message) {
 }
 
 void TcpConnection::sendInLoop(const char* data, size_t len) {
+    Chunk chunk{ data, len, nullptr };
+    sendInLoop(&chunk, 1);
+}
+
+void TcpConnection::sendInLoop(const Chunk* chunks, int count) {
     loop_->assertInLoopThread();
     if (state_ == kDisconnected) {
         LOG_WARN << "TcpConnection::sendInLoop() disconnected, give up send";
         return;
     }
-    ssize_t n = 0;
-    size_t remain = len;
+    size_t len = 0;
+    bool zeroCopy = false;
+    for (int i = 0; i < count; ++i) {
+        len += chunks[i].len;
+        // 需要零拷贝的数据经输出队列发送，由 BufferChain 固定其 holder
+        zeroCopy |= chunks[i].payload != nullptr &&
+                    outputBuffer_.zeroCopyThreshold() > 0 &&
+                    chunks[i].len >= outputBuffer_.zeroCopyThreshold();
+    }
+    size_t written = 0;
     bool faultError = false;
-
-    // 如果没有注册可写事件，输出缓冲区没有数据，则直接发送
-    if (!channel_->isWriting() && outputBuffer_->readableBytes() == 0) {
-        n = ::write(cfd_, data, len);
+    bool attempted = false;
+
+    // 如果没有在等待可写，输出缓冲区没有数据，则直接发送
+    // deferredFlush 模式下只追加，本轮回调结束后统一写出；
+    // 完成模式下追加后由 flushOutput 提交 sendmsg
+    if (!options_.deferredFlush && !zeroCopy && !completion_ &&
+        !waitingWritable() && outputBuffer_.empty()) {
+        ssize_t n = 0;
+        attempted = true;
+        ++directWrites_;
+        if (count == 1) {
+            n = ::write(cfd_, chunks[0].data, chunks[0].len);
+        }
+        else {
+            struct iovec vec[2];
+            assert(count <= 2);
+            for (int i = 0; i < count; ++i) {
+                vec[i].iov_base = const_cast<char*>(chunks[i].data);
+                vec[i].iov_len  = chunks[i].len;
+            }
+            n = ::writev(cfd_, vec, count);
+        }
         if (n == -1) {
-            if (errno != EWOULDBLOCK || errno != EINTR || errno != EAGAIN) {
+            if (errno != EWOULDBLOCK && errno != EINTR) {
                 LOG_SYSERR << "TcpConnection::write()";
                 // remote closed
                 if (errno == EPIPE || errno == ECONNRESET) {
                     faultError = true;
                 }
             }
-            n = 0;
         }
         else {
-            remain -= static_cast<size_t>(n);
-            if (remain == 0 && writeCompleteCallback_) {
+            written = static_cast<size_t>(n);
+            idleEntry_.touch();
+            if (written == len && writeCompleteCallback_) {
                 loop_->queueInLoop([this] {
                     this->writeCompleteCallback_(this->shared_from_this());
                 });
@@ -150,23 +474,132 @@ void TcpConnection::sendInLoop(const char* data, size_t len) {
         }
     }
     // still remain
-    if (!faultError && remain > 0) {
-        if (highWaterMarkCallback_) {
-            size_t oldLen = outputBuffer_->readableBytes();
-            size_t newLen = oldLen + remain;
-            // 超过高水位标记
-            if (oldLen < highWaterMark_ && newLen >= highWaterMark_) {
-                loop_->queueInLoop([this, &newLen] {
-                    this->highWaterMarkCallback_(this->shared_from_this(),
-                                                 newLen);
+    if (!faultError && written < len) {
+        checkHighWaterMark(outputBuffer_.readableBytes(),
+                           outputBuffer_.readableBytes() + len - written);
+        // 将剩余内容添加到 outputbuffer : payload 只挂引用，其余拷贝
+        for (int i = 0; i < count; ++i) {
+            const Chunk& chunk = chunks[i];
+            if (written >= chunk.len) {
+                written -= chunk.len;
+                continue;
+            }
+            if (chunk.payload != nullptr) {
+                outputBuffer_.append(chunk.data + written, chunk.len - written,
+                                     *chunk.payload);
+            }
+            else {
+                outputBuffer_.append(chunk.data + written, chunk.len - written);
+            }
+            written = 0;
+        }
+
+        if (options_.deferredFlush) {
+            scheduleFlush();
+        }
+        else if (attempted) {
+            waitWritable();
+        }
+        else {
+            // 未尝试直接写出 (如零拷贝)，ET 下不会有可写通知，立即写出
+            flushOutput();
+        }
+    }
+}
+
+void TcpConnection::sendFile(int fd, off_t offset, size_t length) {
+    if (state_ != kConnected) {
+        LOG_WARN << "TcpConnection::sendFile() not connected, give up send ";
+        return;
+    }
+    if (length == 0) {
+        return;
+    }
+    int file = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (file == -1) {
+        LOG_SYSERR << "TcpConnection::sendFile() dup";
+        return;
+    }
+    auto holder = std::make_shared<const FileHandle>(file);
+    if (loop_->isInLoopThread()) {
+        sendFileInLoop(holder, file, offset, length);
+    }
+    else {
+        // 与其他线程的 send 走同一个队列，保持先后顺序
+        OutboundMessage message;
+        message.file       = std::move(holder);
+        message.fileFd     = file;
+        message.fileOffset = offset;
+        message.fileLength = length;
+        queueSend(std::move(message));
+    }
+}
+
+void TcpConnection::sendFileInLoop(const std::shared_ptr<const void>& file,
+                                   int                                fd,
+                                   off_t                              offset,
+                                   size_t                             length) {
+    loop_->assertInLoopThread();
+    if (state_ == kDisconnected) {
+        LOG_WARN << "TcpConnection::sendFileInLoop() disconnected, give up send";
+        return;
+    }
+    size_t written = 0;
+    bool attempted = false;
+
+    // 前面没有待发送的数据时直接 sendfile，否则排在输出队列末尾
+    if (!options_.deferredFlush && !waitingWritable() &&
+        outputBuffer_.empty()) {
+        off_t   off = offset;
+        attempted   = true;
+        ssize_t n   = ::sendfile(cfd_, fd, &off, length);
+        ++directWrites_;
+        if (n == -1 && errno != EWOULDBLOCK && errno != EINTR) {
+            // 响应已经无法完整发出，只能关闭连接
+            LOG_SYSERR << "TcpConnection::sendFileInLoop()";
+            forceCloseInLoop();
+            return;
+        }
+        if (n == 0) {
+            LOG_ERROR << "TcpConnection::sendFileInLoop() file shorter than "
+                      << length << " bytes";
+            forceCloseInLoop();
+            return;
+        }
+        if (n > 0) {
+            written = static_cast<size_t>(n);
+            idleEntry_.touch();
+            if (written == length && writeCompleteCallback_) {
+                loop_->queueInLoop([this] {
+                    this->writeCompleteCallback_(this->shared_from_this());
                 });
             }
         }
-        // 将剩余内容添加到 outputbuffer
-        outputBuffer_->append(data + n, remain);
+    }
+    if (written < length) {
+        checkHighWaterMark(outputBuffer_.readableBytes(),
+                           outputBuffer_.readableBytes() + length - written);
+        outputBuffer_.appendFile(fd, offset + static_cast<off_t>(written),
+                                 length - written, file);
+        if (options_.deferredFlush) {
+            scheduleFlush();
+        }
+        else if (attempted) {
+            waitWritable();
+        }
+        else {
+            flushOutput();
+        }
+    }
+}
 
-        if (!channel_->isWriting()) {
-            channel_->enableWriting();
+void TcpConnection::checkHighWaterMark(size_t oldLen, size_t newLen) {
+    if (highWaterMarkCallback_) {
+        // 超过高水位标记
+        if (oldLen < highWaterMark_ && newLen >= highWaterMark_) {
+            loop_->queueInLoop([this, newLen] {
+                this->highWaterMarkCallback_(this->shared_from_this(), newLen);
+            });
         }
     }
 }
@@ -188,7 +621,8 @@ void TcpConnection::shutdown() {
 void TcpConnection::shutdownInLoop() {
     loop_->assertInLoopThread();
 
-    if (state_ != kDisconnected && !channel_->isWriting()) {
+    // 还有数据等待写出时，由 handleWrite / handleFlush 写完后再关闭
+    if (state_ != kDisconnected && !waitingWritable() && !flushPending_) {
         if (::shutdown(cfd_, SHUT_WR) == -1) {
             LOG_SYSERR << "TcpConnection::shutdown()";
         }
@@ -217,65 +651,251 @@ void TcpConnection::forceCloseInLoop() {
 
 void TcpConnection::startRead() {
     loop_->runInLoop([this] {
-        if (!channel_->isReading()) {
+        // 连接可能已在排队期间关闭，此时 channel 已从 poller 中移除
+        if (state_ == kDisconnected || isReading()) {
+            return;
+        }
+        if (!completion_) {
             channel_->enableReading();
+            return;
+        }
+        reading_ = true;
+        if (recvOp_ == 0) {
+            startRecv();
+        }
+        // 暂停期间收到的数据不会再有通知，在下一轮中回调
+        if (pendingInput_) {
+            loop_->queueInLoop([conn = shared_from_this()] {
+                if (conn->pendingInput_ && conn->reading_ &&
+                    conn->state_ != kDisconnected) {
+                    conn->pendingInput_ = false;
+                    conn->messageCallback_(conn, conn->inputBuffer_);
+                }
+            });
         }
     });
 }
 
 void TcpConnection::stopRead() {
     loop_->runInLoop([this] {
-        if (channel_->isReading()) {
+        if (state_ == kDisconnected || !isReading()) {
+            return;
+        }
+        if (!completion_) {
             channel_->disableReading();
+            return;
+        }
+        // 取消之前已经收到的数据留在 inputBuffer_ 中，startRead 时回调
+        reading_ = false;
+        if (recvOp_ != 0) {
+            loop_->poller()->cancel(recvOp_);
         }
     });
 }
 
+void TcpConnection::startRecv() {
+    recvOp_ = loop_->poller()->recvMultishot(cfd_, this, shared_from_this());
+}
+
+void TcpConnection::cancelOps() {
+    if (recvOp_ != 0) {
+        loop_->poller()->cancel(recvOp_);
+    }
+    if (sendOp_ != 0) {
+        loop_->poller()->cancel(sendOp_);
+    }
+}
+
+// Buffer::receive 直接借用 Poller 的 block，数据须恰好位于 prepend 区之后
+static_assert(Poller::kRecvHeadroom == Buffer::kCheapPrepend,
+              "recv block headroom must match Buffer::kCheapPrepend");
+
+void TcpConnection::handleRecvComplete(int   res,
+                                       char* block,
+                                       bool  more,
+                                       bool  nonEmpty) {
+    if (!more) {
+        recvOp_ = 0;
+    }
+    if (state_ == kDisconnected) {
+        return;
+    }
+    if (res > 0) {
+        idleEntry_.touch();
+        inputBuffer_.receive(block, Poller::kRecvBlockSize,
+                             static_cast<size_t>(res));
+        if (nonEmpty && more &&
+            inputBuffer_.readableBytes() < Poller::kRecvBlockSize) {
+            // 与 readv 一次读入 socket 中的数据 (最多约一个 block) 相同 :
+            // 剩余部分紧接着送达，收齐后再回调。否则一条消息的末尾被单独
+            // 回显成小包，受 Nagle 算法与对端延迟确认影响要等待几十毫秒。
+            // 其间 recv 被 stopRead 取消时，数据由 startRead 回调
+            pendingInput_ = true;
+        }
+        else if (reading_) {
+            pendingInput_ = false;
+            messageCallback_(shared_from_this(), inputBuffer_);
+        }
+        else {
+            pendingInput_ = true;
+        }
+        // block 在回调返回后即交还 poller
+        inputBuffer_.detachScratch();
+        if (options_.releaseIdleBuffers) {
+            inputBuffer_.releaseIfEmpty();
+        }
+    }
+    else if (res == 0) {
+        handleClose();
+        return;
+    }
+    else if (res != -ENOBUFS && res != -ECANCELED) {
+        errno = -res;
+        LOG_SYSERR << "TcpConnection::handleRecvComplete()";
+        handleClose();
+        return;
+    }
+    // provided buffer 用尽等原因结束了多次触发的 recv，重新提交
+    if (recvOp_ == 0 && reading_ && state_ != kDisconnected) {
+        startRecv();
+    }
+}
+
+bool TcpConnection::submitSend() {
+    const int count = outputBuffer_.readableIovec(sendIov_, kMaxSendIov);
+    if (count == 0) {
+        return false;
+    }
+    sendMsg_.msg_iov    = sendIov_;
+    sendMsg_.msg_iovlen = static_cast<size_t>(count);
+    sendOp_ =
+        loop_->poller()->sendMsg(cfd_, &sendMsg_, this, shared_from_this());
+    return true;
+}
+
+void TcpConnection::handleSendComplete(int res) {
+    sendOp_ = 0;
+    if (state_ == kDisconnected) {
+        return;
+    }
+    if (res == -EAGAIN || res == -EINTR) {
+        waitWritable();
+        return;
+    }
+    if (res < 0) {
+        errno = -res;
+        LOG_SYSERR << "TcpConnection::handleSendComplete()";
+        forceCloseInLoop();
+        return;
+    }
+    idleEntry_.touch();
+    outputBuffer_.retrieve(static_cast<size_t>(res));
+    if (!outputBuffer_.empty()) {
+        flushOutput();
+    }
+    else {
+        if (options_.releaseIdleBuffers) {
+            outputBuffer_.releaseIfEmpty();
+        }
+        if (writeCompleteCallback_) {
+            loop_->queueInLoop([this] {
+                this->writeCompleteCallback_(this->shared_from_this());
+            });
+        }
+    }
+    if (state_ == kDisconnecting) {
+        shutdownInLoop();
+    }
+}
+
 void TcpConnection::handleRead() {
     loop_->assertInLoopThread();
     assert(state_ != kDisconnected);
+    const bool edgeTriggered = options_.edgeTriggered;
     int savedErrno;
-    ssize_t n = inputBuffer_->readFd(cfd_, &savedErrno);
-    if (n == -1) {
-        errno = savedErrno;
-        LOG_SYSERR << "TcpConnection::handleRead()" << savedErrno;
-        handleError();
-    }
-    else if (n == 0) {
-        handleClose();
+    // ET 下剩余的数据不会再有通知，必须读到 EAGAIN 为止
+    for (;;) {
+        ++readCalls_;
+        ssize_t n = inputBuffer_.readFd(cfd_, &savedErrno);
+        if (n > 0) {
+            idleEntry_.touch();
+            messageCallback_(shared_from_this(), inputBuffer_);
+            // 数据可能读在 loop 共享的 scratch 中，必须在下一次读之前归还
+            inputBuffer_.detachScratch();
+            if (edgeTriggered && state_ != kDisconnected &&
+                channel_->isReading()) {
+                continue;
+            }
+        }
+        else if (n == 0) {
+            handleClose();
+        }
+        else if (edgeTriggered && savedErrno == EINTR) {
+            continue;
+        }
+        else if (!edgeTriggered ||
+                 (savedErrno != EAGAIN && savedErrno != EWOULDBLOCK)) {
+            errno = savedErrno;
+            LOG_SYSERR << "TcpConnection::handleRead()" << savedErrno;
+            handleError();
+        }
+        break;
     }
-    else {
-        messageCallback_(shared_from_this(), *inputBuffer_);
+    inputBuffer_.detachScratch();
+    if (options_.releaseIdleBuffers) {
+        inputBuffer_.releaseIfEmpty();
     }
 }
 
 void TcpConnection::handleWrite() {
+    if (options_.edgeTriggered) {
+        // 可写事件常驻，socket 每次变为可写都会到达，输出队列可能为空
+        writeBlocked_ = false;
+        if (state_ == kDisconnected || outputBuffer_.empty()) {
+            return;
+        }
+    }
     if (state_ == kDisconnected) {
         LOG_WARN << "TcpConnection::handleWrite() disconnected, "
-                 << "give up writing " << outputBuffer_->readableBytes()
+                 << "give up writing " << outputBuffer_.readableBytes()
                  << " bytes";
         return;
     }
-    assert(outputBuffer_->readableBytes() > 0);
-    assert(channel_->isWriting());
-    ssize_t n =
-        ::write(cfd_, outputBuffer_->peek(), outputBuffer_->readableBytes());
-    if (n == -1) {
+    assert(outputBuffer_.readableBytes() > 0);
+    assert(options_.edgeTriggered || channel_->isWriting());
+    // writev 整条链，无需先把数据压缩到连续内存；文件区段使用 sendfile
+    // writeFd 一直写到队列为空或 socket 写满，ET 下同样满足要求
+    int savedErrno = 0;
+    ssize_t n = outputBuffer_.writeFd(cfd_, &savedErrno);
+    if (n > 0) {
+        idleEntry_.touch();
+    }
+    if (n == -1 && savedErrno != EWOULDBLOCK && savedErrno != EINTR) {
+        // 输出流已经无法继续，关闭连接，否则可写事件会一直触发
+        errno = savedErrno;
         LOG_SYSERR << "TcpConnection::write()";
+        forceCloseInLoop();
+    }
+    else if (outputBuffer_.readableBytes() > 0) {
+        if (options_.edgeTriggered) {
+            writeBlocked_ = true;
+        }
     }
     else {
-        outputBuffer_->retrieve(static_cast<size_t>(n));
-        if (outputBuffer_->readableBytes() == 0) {
+        if (!options_.edgeTriggered) {
             channel_->disableWriting();
-            if (writeCompleteCallback_) {
-                loop_->queueInLoop([this] {
-                    this->writeCompleteCallback_(this->shared_from_this());
-                });
-            }
+        }
+        if (options_.releaseIdleBuffers) {
+            outputBuffer_.releaseIfEmpty();
+        }
+        if (writeCompleteCallback_) {
+            loop_->queueInLoop([this] {
+                this->writeCompleteCallback_(this->shared_from_this());
+            });
+        }
 
-            if (state_ == kDisconnecting) {
-                shutdownInLoop();
-            }
+        if (state_ == kDisconnecting) {
+            shutdownInLoop();
         }
     }
 }
@@ -285,16 +905,81 @@ void TcpConnection::handleClose() {
     auto old_state = state_.exchange(kDisconnected);
     assert(old_state <= kDisconnecting);
     (void)old_state;
-    loop_->removeChannel(channel_.get());
+    cancelOps();
+    // stopRead 且没有等待可写时 channel 已不在 poller 中
+    if (channel_->polling()) {
+        loop_->removeChannel(channel_.get());
+    }
+    loop_->idleWheel().remove(&idleEntry_);
     closeCallback_(shared_from_this());
 }
 
+void TcpConnection::setIdleTimeout(Nanoseconds timeout) {
+    loop_->assertInLoopThread();
+    idleTimeout_ = timeout;
+    if (state_ == kConnected) {
+        loop_->idleWheel().remove(&idleEntry_);
+        if (timeout.count() > 0) {
+            loop_->idleWheel().add(&idleEntry_, timeout);
+        }
+    }
+}
+
+void TcpConnection::handleIdle() {
+    // 关闭连接的过程中可能释放最后一个引用
+    TcpConnectionPtr guard(shared_from_this());
+    if (idleTimeoutCallback_) {
+        idleTimeoutCallback_(guard);
+        return;
+    }
+    LOG_INFO << "TcpConnection " << name() << " idle for "
+             << idleTimeout_.count() / 1000000 << "ms, force close";
+    forceClose();
+}
+
 void TcpConnection::handleError() {
+    // 零拷贝的完成通知也以 EPOLLERR 的形式到达
+    if (zeroCopy_) {
+        handleZeroCopyCompletions();
+    }
     int err = 0;
     socklen_t len = sizeof(err);
     int ret = getsockopt(cfd_, SOL_SOCKET, SO_ERROR, &err, &len);
     if (ret != -1) {
+        if (err == 0 && zeroCopy_) {
+            return;
+        }
         errno = err;
     }
     LOG_SYSERR << "TcpConnection::handleError()" << errno;
 }
+
+void TcpConnection::enableZeroCopy() {
+    int on = 1;
+    if (::setsockopt(cfd_, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) == -1) {
+        LOG_SYSERR << "TcpConnection::enableZeroCopy() fd=" << cfd_;
+        return;
+    }
+    zeroCopy_ = true;
+    outputBuffer_.setZeroCopyThreshold(options_.zeroCopyThreshold);
+}
+
+void TcpConnection::enableBusyPoll() {
+    int usecs = options_.busyPollMicros;
+    if (::setsockopt(cfd_, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs)) ==
+        -1) {
+        LOG_SYSERR << "TcpConnection::enableBusyPoll() fd=" << cfd_;
+    }
+}
+
+void TcpConnection::handleZeroCopyCompletions() {
+    readZeroCopyCompletions(cfd_, [this](uint32_t hi, bool copied) {
+        outputBuffer_.releaseZeroCopy(hi);
+        if (copied && outputBuffer_.zeroCopyThreshold() > 0) {
+            // 内核退回了拷贝 (如 loopback)，零拷贝只剩额外开销
+            LOG_DEBUG << "TcpConnection zerocopy fell back to copy, "
+                      << "disabled for " << name();
+            outputBuffer_.setZeroCopyThreshold(0);
+        }
+    });
+}
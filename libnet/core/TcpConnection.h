@@ -2,27 +2,41 @@
 #define LIBNET_TCPCONNECTION_H
 
 #include "core/Buffer.h"
+#include "core/BufferChain.h"
 #include "core/Callbacks.h"
 #include "core/Channel.h"
+#include "core/ConnectionOptions.h"
 #include "core/EventLoop.h"
+#include "core/IdleWheel.h"
 #include "core/InetAddress.h"
+#include "core/Poller.h"
 #include "core/Timestamp.h"
+#include "utils/MpscQueue.h"
 #include "utils/noncopyable.h"
 
 #include <any>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <utility>
 
 namespace libnet {
 
 class EventLoop;
 
+// Poller 支持完成模式 (io_uring) 时，数据由 poller 接收到它提供的缓冲区、
+// 以 sendmsg 批量提交发送，不再调用 read/write；零拷贝与边沿触发的选项不适用，
+// 输出队列以文件区段开头时仍以 sendfile 写出
 class TcpConnection : private noncopyable,
+                      private Poller::CompletionHandler,
                       public std::enable_shared_from_this<TcpConnection>
 {
 public:
+    // heartbeat : 空闲超时，这么久没有读写即回调 idleTimeoutCallback，
+    // 未设置时关闭连接；0 表示不检测
     TcpConnection(EventLoop*         loop,
                   int                cfd,
                   const InetAddress& local,
@@ -37,14 +51,52 @@ public:
 
     void send(const std::string& data);
     void send(const char* data, size_t len);
+    // 发送后 buffer 为空；在其他线程调用时，来自内存池的 buffer (如消息回调
+    // 中的输入 Buffer) 会被拷贝，只有堆上的存储才被直接接管
     void send(Buffer& buffer);
+    // 以下发送方式不拷贝数据 : 未能立即写出的部分以引用的形式挂到输出队列上
+    void send(std::string&& data);
+    void send(const BufferChain::Payload& payload);
+    // header 与 body 合并为一次 writev 发送
+    void send(Buffer& header, const BufferChain::Payload& body);
+    // 以 sendfile 发送文件 fd 中 [offset, offset+length) 的内容，与前后的
+    // send() 保持顺序。内部 dup 一份 fd，调用返回后即可关闭原 fd
+    void sendFile(int fd, off_t offset, size_t length);
+    // 直接写入输出队列尾部的预留空间，省去先拼成临时 string/Buffer 再拷贝:
+    //   auto w = conn->beginWrite(n); ...写入 w.data()...; w.commit(k);
+    // 只能在 loop 线程中使用，commit 之前不能有其他 send
+    class OutputWriter
+    {
+    public:
+        char*  data() const { return data_; }
+        size_t size() const { return size_; }
+        // 提交前 len 字节并写出 (deferredFlush 模式下在本轮事件结束时写出)
+        void commit(size_t len) { conn_->commitWrite(len); }
+
+    private:
+        friend class TcpConnection;
+        OutputWriter(TcpConnection* conn, char* data, size_t size)
+            : conn_(conn), data_(data), size_(size) {}
+
+        TcpConnection* conn_;
+        char*          data_;
+        size_t         size_;
+    };
+
+    // 预留至少 n 字节的连续空间
+    OutputWriter beginWrite(size_t n);
+
     void shutdown();
     void forceClose();
 
     void startRead();
     void stopRead();
     // not thread safe
-    bool isReading() { return channel_->isReading(); }
+    bool isReading() { return completion_ ? reading_ : channel_->isReading(); }
+
+    // 修改空闲超时并重新计时，0 表示不检测。只能在 loop 线程中调用
+    void        setIdleTimeout(Nanoseconds timeout);
+    Nanoseconds idleTimeout() const { return idleTimeout_; }
 
     void setMessageCallback(const MessageCallback& messageCallback) {
         messageCallback_ = messageCallback;
@@ -65,6 +117,10 @@ public:
     void setConnectionCallback(const ConnectionCallback& connectionCallback) {
         connectionCallback_ = connectionCallback;
     }
+    // 回调之后重新计时，仍然空闲时会再次回调
+    void setIdleTimeoutCallback(const IdleTimeoutCallback& idleTimeoutCallback) {
+        idleTimeoutCallback_ = idleTimeoutCallback;
+    }
 
     void setMessageCallback(MessageCallback&& messageCallback) {
         messageCallback_ = std::move(messageCallback);
@@ -85,14 +141,38 @@ public:
         connectionCallback_ = std::move(connectionCallback);
     }
 
+    // should be called before connectionEstablished
+    void setOptions(const ConnectionOptions& options) { options_ = options; }
+    const ConnectionOptions& options() const { return options_; }
+    void setReleaseIdleBuffers(bool on) { options_.releaseIdleBuffers = on; }
+    // 见 ConnectionOptions::zeroCopyThreshold；连接关闭时仍在途的零拷贝数据
+    // 连同 fd 交给 loop 的 ZeroCopyGraveyard，保留到完成通知到达
+    void setZeroCopyThreshold(size_t threshold) {
+        options_.zeroCopyThreshold = threshold;
+    }
+    bool zeroCopy() const { return zeroCopy_; }
+    // 见 ConnectionOptions::deferredFlush
+    void setDeferredFlush(bool on) { options_.deferredFlush = on; }
+    // 见 ConnectionOptions::edgeTriggered
+    void setEdgeTriggered(bool on) { options_.edgeTriggered = on; }
+
+    // 写出数据所用的系统调用次数 (write/writev/sendfile/send)
+    // not thread safe
+    uint64_t writeSyscalls() const {
+        return directWrites_ + outputBuffer_.writeCalls();
+    }
+    // 读入数据所用的系统调用次数，完成模式下为 0
+    // not thread safe
+    uint64_t readSyscalls() const { return readCalls_; }
+
     const InetAddress& local() const { return *local_; }
     const InetAddress& peer() const { return *peer_; }
     std::string        name() const {
         return peer_->toIpPort() + " -> " + local_->toIpPort();
     }
 
-    const Buffer& inputBuffer() const { return *inputBuffer_; }
-    const Buffer& outputBuffer() const { return *outputBuffer_; }
+    const Buffer&      inputBuffer() const { return inputBuffer_; }
+    const BufferChain& outputBuffer() const { return outputBuffer_; }
 
     const std::any& getContext() const { return context_; }
     std::any*       getMutableContext() { return &context_; }
@@ -107,9 +187,80 @@ private:
     void handleWrite();
     void handleClose();
     void handleError();
+    void handleIdle();
+    void enableZeroCopy();
+    void enableBusyPoll();
+    void handleZeroCopyCompletions();
+
+    // 完成模式
+    void startRecv();
+    // 以 sendmsg 提交输出队列开头的内存片段，开头为文件区段时返回 false
+    bool submitSend();
+    void cancelOps();
+    void handleRecvComplete(int  res,
+                            char* block,
+                            bool  more,
+                            bool  nonEmpty) override;
+    void handleSendComplete(int res) override;
+
+    // 一次发送中的一段数据，payload 不为空时剩余部分只保存引用
+    struct Chunk
+    {
+        const char*                 data;
+        size_t                      len;
+        const BufferChain::Payload* payload;
+    };
 
     void sendInLoop(const std::string& message);
     void sendInLoop(const char* data, size_t len);
+    void sendInLoop(const Chunk* chunks, int count);
+    void sendFileInLoop(const std::shared_ptr<const void>& file,
+                        int                                fd,
+                        off_t                              offset,
+                        size_t                             length);
+    // 输出队列由 oldLen 增长到 newLen，越过高水位时回调
+    void checkHighWaterMark(size_t oldLen, size_t newLen);
+
+    // 其他线程发送的一条消息，按 data、buffer、payload、文件区段的顺序写出
+    struct OutboundMessage
+    {
+        OutboundMessage()
+            : buffer(BufferPool::ptr()),
+              fileFd(-1),
+              fileOffset(0),
+              fileLength(0) {}
+
+        std::string                 data;
+        Buffer                      buffer;
+        BufferChain::Payload        payload;
+        std::shared_ptr<const void> file;  // 持有 dup 出的 fileFd
+        int                         fileFd;
+        off_t                       fileOffset;
+        size_t                      fileLength;
+    };
+
+    // 把其他线程发送的 buffer 放入 message，调用方的 buffer 随后为空
+    static void takeBuffer(Buffer& buffer, OutboundMessage* message);
+    void        queueSend(OutboundMessage&& message);
+    void        drainSendQueue();
+
+    // 正在等待 socket 可写 : LT 下即已注册可写事件，
+    // ET 下可写事件常驻，由 writeBlocked_ 记录上一次写出是否被阻塞；
+    // 完成模式下还包括有 sendmsg 在途
+    bool waitingWritable() const {
+        if (sendOp_ != 0) {
+            return true;
+        }
+        return options_.edgeTriggered ? writeBlocked_ : channel_->isWriting();
+    }
+    // 输出队列在一次写出尝试之后仍有剩余，等待下一次可写通知
+    void waitWritable();
+
+    // 立即写出输出队列，写不完时注册可写事件
+    void flushOutput();
+    void commitWrite(size_t len);
+    void scheduleFlush();
+    void handleFlush();
 
     void shutdownInLoop();
     void forceCloseInLoop();
@@ -120,8 +271,8 @@ private:
     std::unique_ptr<Channel>     channel_;
     std::unique_ptr<InetAddress> local_;
     std::unique_ptr<InetAddress> peer_;
-    std::unique_ptr<Buffer>      inputBuffer_;
-    std::unique_ptr<Buffer>      outputBuffer_;
+    Buffer                       inputBuffer_;
+    BufferChain                  outputBuffer_;
     std::any                     context_;
 
     MessageCallback       messageCallback_;
@@ -129,7 +280,31 @@ private:
     WriteCompleteCallback writeCompleteCallback_;
     HighWaterMarkCallback highWaterMarkCallback_;
     ConnectionCallback    connectionCallback_;
+    IdleTimeoutCallback   idleTimeoutCallback_;
     size_t                highWaterMark_;
+    ConnectionOptions     options_;
+    bool                  zeroCopy_;  // 已设置 SO_ZEROCOPY
+    Nanoseconds           idleTimeout_;
+    IdleWheel::Entry      idleEntry_;
+
+    // 每个连接只缓存少量节点，避免大量连接时占用过多内存
+    MpscQueue<OutboundMessage, 16> sendQueue_;
+    std::atomic<bool>             sendQueueScheduled_;
+    bool                          flushPending_;  // 已在 loop 中登记 flush
+    bool                          writeBlocked_;  // ET : 写到 EAGAIN，等待可写边沿
+    uint64_t                      directWrites_;
+    uint64_t                      readCalls_;
+
+    // 完成模式，见 Poller::completionMode
+    static const int kMaxSendIov = 32;
+
+    bool          completion_;
+    bool          reading_;       // 没有 stopRead
+    bool          pendingInput_;  // stopRead 之后收到的数据尚未回调
+    Poller::OpId  recvOp_;
+    Poller::OpId  sendOp_;  // 在途的 sendmsg，完成前输出队列的开头不能改动
+    struct msghdr sendMsg_;
+    struct iovec  sendIov_[kMaxSendIov];
 };
 
 }  // namespace libnet
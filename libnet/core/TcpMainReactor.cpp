@@ -31,6 +31,9 @@ void TcpMainReactor::setNumThreads(size_t numThreads) {
 void TcpMainReactor::start() {
     if (started_.exchange(true) == false) {
         threadPool_->start();
+        for (EventLoop* loop : threadPool_->getAllLoops()) {
+            setupLoop(loop);
+        }
         acceptor_->listen();
     }
 }
@@ -47,6 +50,8 @@ void TcpMainReactor::newConnection(int connfd,
 
     connPtr->setMessageCallback(messageCallback_);
     connPtr->setWriteCompleteCallback(writeCompleteCallback_);
+    connPtr->setIdleTimeoutCallback(idleTimeoutCallback_);
+    connPtr->setOptions(connectionOptions_);
     connPtr->setCloseCallback(
         std::bind(&TcpMainReactor::closeConnection, this, _1));
     connPtr->setConnectionCallback(connectionCallback_);
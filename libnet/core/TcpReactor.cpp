@@ -8,6 +8,7 @@
 
 #include "core/TcpReactor.h"
 #include "core/EventLoop.h"
+#include "core/LoopWatchdog.h"
 #include "core/TcpConnection.h"
 #include <memory>
 
@@ -22,10 +23,16 @@ TcpReactor::TcpReactor(EventLoop*         loop,
       connectionCallback_(),
       messageCallback_(),
       writeCompleteCallback_(),
+      connectionOptions_(),
       heartbeat_(heartbeat),
+      busyPoll_(0),
+      prepareHook_(),
+      checkHook_(),
+      idleHook_(),
+      watchdog_(nullptr),
       started_(false),
       numThreads_(1),
-      local_() {}
+      local_(local) {}
 
 TcpReactor::~TcpReactor() {
     for (auto& item : connections_) {
@@ -36,3 +43,19 @@ TcpReactor::~TcpReactor() {
         conn->getLoop()->runInLoop(std::bind(&TcpConnection::forceClose, conn));
     }
 }
+
+void TcpReactor::setupLoop(EventLoop* loop) const {
+    loop->setBusyPoll(busyPoll_);
+    if (prepareHook_) {
+        loop->addPrepareHook(prepareHook_);
+    }
+    if (checkHook_) {
+        loop->addCheckHook(checkHook_);
+    }
+    if (idleHook_) {
+        loop->addIdleHook(idleHook_);
+    }
+    if (watchdog_ != nullptr) {
+        watchdog_->watch(loop);
+    }
+}
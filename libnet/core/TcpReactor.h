@@ -11,6 +11,7 @@
 
 #include "core/Acceptor.h"
 #include "core/Callbacks.h"
+#include "core/ConnectionOptions.h"
 #include "core/EventLoopThreadPool.h"
 #include "core/TimerQueue.h"
 #include "core/Timestamp.h"
@@ -23,6 +24,8 @@
 
 namespace libnet {
 
+class LoopWatchdog;
+
 class TcpReactor : noncopyable
 {
 public:
@@ -50,6 +53,29 @@ public:
         writeCompleteCallback_ = writeCompleteCallback;
     }
 
+    void setIdleTimeoutCallback(const IdleTimeoutCallback& idleTimeoutCallback) {
+        idleTimeoutCallback_ = idleTimeoutCallback;
+    }
+
+    void setConnectionOptions(const ConnectionOptions& connectionOptions) {
+        connectionOptions_ = connectionOptions;
+    }
+
+    // 所有 I/O loop 的 busy-poll 自旋上限，见 EventLoop::setBusyPoll
+    void setBusyPoll(Nanoseconds maxSpin) { busyPoll_ = maxSpin; }
+
+    // 注册到每个 I/O loop 上的阶段钩子，见 EventLoop::addPrepareHook 等
+    void setLoopHooks(const LoopHook& prepare,
+                      const LoopHook& check,
+                      const IdleHook& idle) {
+        prepareHook_ = prepare;
+        checkHook_   = check;
+        idleHook_    = idle;
+    }
+
+    // 由 watchdog 监视所有 I/O loop，为空表示不监视
+    void setWatchdog(LoopWatchdog* watchdog) { watchdog_ = watchdog; }
+
     ConnectionSet connections() const { return connections_; }
 
 protected:
@@ -58,13 +84,23 @@ protected:
                                const InetAddress& peer)        = 0;
     virtual void closeConnection(const TcpConnectionPtr& conn) = 0;
 
+    // 为 I/O loop 应用 busy-poll、阶段钩子与 watchdog
+    void setupLoop(EventLoop* loop) const;
+
     EventLoop*            loop_;
     Acceptor::ptr         acceptor_;
     ConnectionSet         connections_;
     ConnectionCallback    connectionCallback_;
     MessageCallback       messageCallback_;
     WriteCompleteCallback writeCompleteCallback_;
+    IdleTimeoutCallback   idleTimeoutCallback_;
+    ConnectionOptions     connectionOptions_;
     Nanoseconds           heartbeat_;
+    Nanoseconds           busyPoll_;
+    LoopHook              prepareHook_;
+    LoopHook              checkHook_;
+    IdleHook              idleHook_;
+    LoopWatchdog*         watchdog_;
     std::atomic_bool      started_;
     int                   numThreads_;
     InetAddress           local_;
@@ -28,10 +28,12 @@ TcpServer::TcpServer(EventLoop*         loop,
       local_(local),
       ipPort_(local.toIpPort()),
       heartbeat_(heartbeat),
+      busyPoll_(0),
       reusePort_(reusePort),
       threadInitCallback_(defaultThreadInitCallback),
       connectionCallback_(defaultConnectionCallback),
-      messageCallback_(defaultMessageCallback) {
+      messageCallback_(defaultMessageCallback),
+      watchdog_(nullptr) {
     LOG_TRACE << "Creating TcpServer() " << local.toIpPort();
 }
 
@@ -73,6 +75,11 @@ void TcpServer::startInLoop() {
     reactor_->setConnectionCallback(connectionCallback_);
     reactor_->setMessageCallback(messageCallback_);
     reactor_->setWriteCompleteCallback(writeCompleteCallback_);
+    reactor_->setIdleTimeoutCallback(idleTimeoutCallback_);
+    reactor_->setConnectionOptions(connectionOptions_);
+    reactor_->setBusyPoll(busyPoll_);
+    reactor_->setLoopHooks(prepareHook_, checkHook_, idleHook_);
+    reactor_->setWatchdog(watchdog_);
 
     // main thread
     threadInitCallback_(0);
@@ -2,6 +2,7 @@
 #define LIBNET_TCPSERVER_H
 
 #include "core/Callbacks.h"
+#include "core/ConnectionOptions.h"
 #include "core/EventLoopThreadPool.h"
 #include "core/InetAddress.h"
 #include "core/TcpReactor.h"
@@ -18,10 +19,13 @@ namespace libnet {
 
 class EventLoop;
 class EventLoopThread;
+class LoopWatchdog;
 
 class TcpServer : noncopyable
 {
 public:
+    // heartbeat : 连接的空闲超时，这么久没有读写的连接被关闭
+    // (设置了 idleTimeoutCallback 时改为回调)，0 表示不检测
     TcpServer(EventLoop*         loop,
               const InetAddress& local,
               bool               reusePort = true,
@@ -31,6 +35,29 @@ public:
     // should be called before start
     void disableReusePort() { reusePort_ = false; }
     void setNumThreads(size_t numThreads);
+    void setReleaseIdleBuffers(bool on) {
+        connectionOptions_.releaseIdleBuffers = on;
+    }
+    void setZeroCopyThreshold(
+        size_t threshold = ConnectionOptions::kDefaultZeroCopyThreshold) {
+        connectionOptions_.zeroCopyThreshold = threshold;
+    }
+    void setDeferredFlush(bool on) { connectionOptions_.deferredFlush = on; }
+    void setEdgeTriggered(bool on) { connectionOptions_.edgeTriggered = on; }
+    // I/O loop 空闲时先自旋最多 maxSpin 再阻塞，socketBusyPollMicros > 0 时
+    // 同时为连接设置 SO_BUSY_POLL
+    void setBusyPoll(Nanoseconds maxSpin, int socketBusyPollMicros = 0) {
+        busyPoll_                         = maxSpin;
+        connectionOptions_.busyPollMicros = socketBusyPollMicros;
+    }
+    // 在每个 I/O loop 上注册阶段钩子，见 EventLoop::addPrepareHook 等；
+    // 钩子在各 loop 线程中执行，可用 EventLoop::getEventLoopOfCurrentThread()
+    // 区分所在的 loop
+    void setPrepareHook(const LoopHook& hook) { prepareHook_ = hook; }
+    void setCheckHook(const LoopHook& hook) { checkHook_ = hook; }
+    void setIdleHook(const IdleHook& hook) { idleHook_ = hook; }
+    // 由 watchdog 监视所有 I/O loop，watchdog 须比 TcpServer 活得更久
+    void setWatchdog(LoopWatchdog* watchdog) { watchdog_ = watchdog; }
     void start();
 
     void setThreadInitCallback(const ThreadInitCallback& threadInitCallback) {
@@ -46,6 +73,10 @@ public:
         const WriteCompleteCallback& writeCompleteCallback) {
         writeCompleteCallback_ = writeCompleteCallback;
     }
+    // 连接空闲超时时由应用决定如何处理 (关闭、发送心跳等)，回调后重新计时
+    void setIdleTimeoutCallback(const IdleTimeoutCallback& idleTimeoutCallback) {
+        idleTimeoutCallback_ = idleTimeoutCallback;
+    }
 
     size_t             numThreads() const { return numThreads_; }
     EventLoop*         getLoop() const { return baseLoop_; }
@@ -67,6 +98,7 @@ private:
     const std::string ipPort_;
 
     Nanoseconds heartbeat_;
+    Nanoseconds busyPoll_;
 
     bool reusePort_;
 
@@ -74,6 +106,12 @@ private:
     ConnectionCallback    connectionCallback_;
     MessageCallback       messageCallback_;
     WriteCompleteCallback writeCompleteCallback_;
+    IdleTimeoutCallback   idleTimeoutCallback_;
+    ConnectionOptions     connectionOptions_;
+    LoopHook              prepareHook_;
+    LoopHook              checkHook_;
+    IdleHook              idleHook_;
+    LoopWatchdog*         watchdog_;
 };
 
 }  // namespace libnet
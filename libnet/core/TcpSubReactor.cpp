@@ -27,12 +27,28 @@ TcpSubReactor::TcpSubReactor(EventLoop* loop,
         std::bind(&TcpSubReactor::newConnection, this, _1, _2, _3));
 }
 
+TcpSubReactor::~TcpSubReactor() {
+    // 退出并等待其他 I/O 线程 (在 loop 中 quit，避免 loop() 开始前的 quit 被覆盖)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        for (EventLoop* loop : eventLoops_) {
+            if (loop != nullptr && loop != loop_) {
+                loop->queueInLoop([loop] { loop->quit(); });
+            }
+        }
+    }
+    for (auto& thread : threads_) {
+        thread->join();
+    }
+}
+
 void TcpSubReactor::setNumThreads(size_t numThreads) {
     eventLoops_.resize(numThreads);
     numThreads_ = numThreads;
 }
 
 void TcpSubReactor::start() {
+    setupLoop(loop_);
     acceptor_->listen();
 
     // create numThreads-1 threads and loop
@@ -63,6 +79,8 @@ void TcpSubReactor::newConnection(int connfd,
     connPtr->setConnectionCallback(connectionCallback_);
     connPtr->setMessageCallback(messageCallback_);
     connPtr->setWriteCompleteCallback(writeCompleteCallback_);
+    connPtr->setIdleTimeoutCallback(idleTimeoutCallback_);
+    connPtr->setOptions(connectionOptions_);
     connPtr->setCloseCallback(
         std::bind(&TcpSubReactor::closeConnection, this, _1));
     connPtr->connectionEstablished();
@@ -84,17 +102,24 @@ void TcpSubReactor::runInThread(const size_t index) {
     reactor.setConnectionCallback(connectionCallback_);
     reactor.setMessageCallback(messageCallback_);
     reactor.setWriteCompleteCallback(writeCompleteCallback_);
+    reactor.setIdleTimeoutCallback(idleTimeoutCallback_);
+    reactor.setConnectionOptions(connectionOptions_);
+    reactor.setBusyPoll(busyPoll_);
+    reactor.setLoopHooks(prepareHook_, checkHook_, idleHook_);
+    reactor.setWatchdog(watchdog_);
 
+    // threadInitCallback_(index);
+    reactor.start();
+
+    // 开始监听后再通知，start() 返回时所有线程都已在接受连接
     {
         std::lock_guard<std::mutex> guard(mutex_);
         eventLoops_[index] = &loop;
         cond_.notify_one();
     }
-
-    // threadInitCallback_(index);
-    reactor.start();
     loop.loop();
 
     // stop looping
+    std::lock_guard<std::mutex> guard(mutex_);
     eventLoops_[index] = nullptr;
 }
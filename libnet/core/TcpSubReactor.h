@@ -30,7 +30,7 @@ public:
     TcpSubReactor(EventLoop* loop,
                   const InetAddress& local,
                   const Nanoseconds heartbeat);
-    ~TcpSubReactor() = default;
+    ~TcpSubReactor() override;
 
     void setNumThreads(size_t numThreads) override;
     void start() override;
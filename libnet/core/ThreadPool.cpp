@@ -23,21 +23,6 @@ ThreadPool::~ThreadPool() {
     LOG_TRACE << "~ThreadPool()";
 }
 
-void ThreadPool::runTask(const Task& task) {
-    assert(running_);
-
-    if (threads_.empty()) {
-        task();
-    }
-    else {
-        std::unique_lock<std::mutex> lock(mutex_);
-        while (taskQueue_.size() >= maxQueueSize_)
-            notFull_.wait(lock);
-        taskQueue_.push_back(task);
-        notEmpty_.notify_one();
-    }
-}
-
 void ThreadPool::runTask(Task&& task) {
     assert(running_);
 
@@ -80,7 +65,7 @@ Task ThreadPool::take() {
 
     Task task;
     if (!taskQueue_.empty()) {
-        task = taskQueue_.front();
+        task = std::move(taskQueue_.front());
         taskQueue_.pop_front();
         notFull_.notify_one();
     }
@@ -21,7 +21,6 @@ public:
                         const ThreadInitCallback& cb = nullptr);
     ~ThreadPool();
 
-    void runTask(const Task& task);
     void runTask(Task&& task);
 
     void stop();
@@ -2,28 +2,38 @@
 #define LIBNET_TIMER_H
 
 #include "core/Callbacks.h"
-#include "core/Channel.h"
 #include "core/Timestamp.h"
-#include <any>
+#include "utils/noncopyable.h"
+#include <atomic>
 #include <cassert>
-#include <memory>
+#include <cstddef>
+#include <cstdint>
 
 namespace libnet {
 
+class TimerHeap;
+class TimerPool;
+class TimerQueue;
+class TimingWheel;
+
+// 定时器由所属 loop 的 TimerPool 分配并复用，外部以 TimerId 引用
 class Timer : noncopyable
 {
 public:
-    using sptr = std::shared_ptr<Timer>;
-
-    Timer(TimerCallback callback,
-          Timestamp     when,
-          Nanoseconds   interval,
-          bool          repeat)
-        : callback_(std::move(callback)),
-          when_(when),
-          interval_(interval),
-          repeat_(repeat),
-          canceled_(false) {}
+    Timer()
+        : callback_(),
+          when_(),
+          interval_(Nanoseconds::zero()),
+          repeat_(false),
+          canceled_(false),
+          state_(kFree),
+          index_(0),
+          generation_(0),
+          nextFree_(0),
+          heapIndex_(kNotInHeap),
+          prev_(nullptr),
+          next_(nullptr),
+          slot_(-1) {}
 
     void run() {
         if (callback_)
@@ -35,29 +45,50 @@ public:
         when_ += interval_;
     }
 
-    void cancel() {
-        assert(!canceled_);
-        canceled_ = true;
-    }
-
     bool expired(Timestamp now) const { return now >= when_; }
 
+    // 只能在 TimerStore 之外修改
+    void setWhen(Timestamp when) { when_ = when; }
+
     // getter
     Timestamp when() const { return when_; }
     bool      repeat() const { return repeat_; }
     bool      canceled() const { return canceled_; }
 
-    const TimerCallback& timerCallback() const { return callback_; }
-    void                 setTimerCallback(TimerCallback callback) {
-        callback_ = std::move(callback);
-    }
-
 private:
+    friend class TimerHeap;
+    friend class TimerPool;
+    friend class TimerQueue;
+    friend class TimingWheel;
+
+    enum State : uint8_t
+    {
+        kFree,       // 在 TimerPool 的空闲链表中
+        kPending,    // 已分配，等待 loop 线程加入 TimerStore
+        kScheduled,  // 在 TimerStore 中等待到期
+        kRunning,    // 已到期，正在执行回调
+    };
+
+    static const size_t kNotInHeap = SIZE_MAX;
+
     TimerCallback callback_;
     Timestamp     when_;
     Nanoseconds   interval_;
-    const bool    repeat_;
+    bool          repeat_;
     bool          canceled_;
+    State         state_;
+
+    // TimerPool : 池中的下标；代数在释放时递增，使旧的 TimerId 失效；
+    // 空闲链表中下一个 Timer 的下标 + 1
+    uint32_t              index_;
+    std::atomic<uint32_t> generation_;
+    std::atomic<uint32_t> nextFree_;
+    // TimerHeap : 在堆数组中的下标
+    size_t heapIndex_;
+    // TimingWheel : 所在槽的侵入式双向链表
+    Timer* prev_;
+    Timer* next_;
+    int    slot_;
 };
 
 }  // namespace libnet
@@ -0,0 +1,120 @@
+#include "core/TimerHeap.h"
+
+#include <cassert>
+
+using namespace libnet;
+
+TimerHeap::~TimerHeap() {
+    for (const Entry& entry : heap_) {
+        entry.timer->heapIndex_ = Timer::kNotInHeap;
+    }
+}
+
+void TimerHeap::add(Timer* timer) {
+    assert(timer->heapIndex_ == Timer::kNotInHeap);
+    heap_.push_back({ timer->when(), timer });
+    timer->heapIndex_ = heap_.size() - 1;
+    siftUp(heap_.size() - 1);
+}
+
+void TimerHeap::remove(Timer* timer) {
+    if (timer->heapIndex_ == Timer::kNotInHeap) {
+        return;
+    }
+    removeAt(timer->heapIndex_);
+}
+
+void TimerHeap::update(Timer* timer, Timestamp when) {
+    timer->setWhen(when);
+    const size_t index = timer->heapIndex_;
+    if (index == Timer::kNotInHeap) {
+        add(timer);
+        return;
+    }
+    const Timestamp old = heap_[index].when;
+    heap_[index].when   = when;
+    if (when < old) {
+        siftUp(index);
+    }
+    else {
+        siftDown(index);
+    }
+}
+
+bool TimerHeap::nextDeadline(Timestamp* when) {
+    if (heap_.empty()) {
+        return false;
+    }
+    *when = heap_.front().when;
+    return true;
+}
+
+void TimerHeap::takeExpired(Timestamp now, TimerList& expired) {
+    while (!heap_.empty() && heap_.front().when <= now) {
+        Timer* timer = heap_.front().timer;
+        removeAt(0);
+        expired.push_back(timer);
+    }
+}
+
+void TimerHeap::takeAll(TimerList& timers) {
+    for (const Entry& entry : heap_) {
+        entry.timer->heapIndex_ = Timer::kNotInHeap;
+        timers.push_back(entry.timer);
+    }
+    heap_.clear();
+}
+
+void TimerHeap::removeAt(size_t index) {
+    heap_[index].timer->heapIndex_ = Timer::kNotInHeap;
+    const Entry last               = heap_.back();
+    heap_.pop_back();
+    if (index == heap_.size()) {
+        return;
+    }
+    const Timestamp old = heap_[index].when;
+    set(index, last);
+    if (last.when < old) {
+        siftUp(index);
+    }
+    else {
+        siftDown(index);
+    }
+}
+
+void TimerHeap::siftUp(size_t index) {
+    const Entry entry = heap_[index];
+    while (index > 0) {
+        const size_t parent = (index - 1) / kArity;
+        if (!(entry.when < heap_[parent].when)) {
+            break;
+        }
+        set(index, heap_[parent]);
+        index = parent;
+    }
+    set(index, entry);
+}
+
+void TimerHeap::siftDown(size_t index) {
+    const Entry  entry = heap_[index];
+    const size_t size  = heap_.size();
+    for (;;) {
+        const size_t first = index * kArity + 1;
+        if (first >= size) {
+            break;
+        }
+        const size_t last = first + kArity < size ? first + kArity : size;
+        size_t       min  = first;
+        for (size_t child = first + 1; child < last; ++child) {
+            if (heap_[child].when < heap_[min].when) {
+                min = child;
+            }
+        }
+        if (!(heap_[min].when < entry.when)) {
+            break;
+        }
+        set(index, heap_[min]);
+        index = min;
+    }
+    set(index, entry);
+}
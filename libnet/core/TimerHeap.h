@@ -0,0 +1,52 @@
+#ifndef LIBNET_TIMERHEAP_H
+#define LIBNET_TIMERHEAP_H
+
+#include "core/TimerStore.h"
+#include <cstddef>
+#include <vector>
+
+namespace libnet {
+
+// 带下标的 4 叉小根堆，每个 Timer 记录自己在堆中的位置：
+// 加入、移除、原地修改到期时间均为 O(log n)，堆的大小始终等于定时器数。
+// 条目内联到期时间，比较时不必访问 Timer
+class TimerHeap : public TimerStore
+{
+public:
+    TimerHeap() : heap_() {}
+    ~TimerHeap() override;
+
+    void add(Timer* timer) override;
+    void remove(Timer* timer) override;
+    void update(Timer* timer, Timestamp when) override;
+
+    bool nextDeadline(Timestamp* when) override;
+    void takeExpired(Timestamp now, TimerList& expired) override;
+    void takeAll(TimerList& timers) override;
+
+    size_t      size() const override { return heap_.size(); }
+    const char* name() const override { return "heap"; }
+
+private:
+    static const size_t kArity = 4;
+
+    struct Entry
+    {
+        Timestamp when;
+        Timer*    timer;
+    };
+
+    void set(size_t index, const Entry& entry) {
+        heap_[index]             = entry;
+        entry.timer->heapIndex_ = index;
+    }
+    void removeAt(size_t index);
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+
+    std::vector<Entry> heap_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_TIMERHEAP_H
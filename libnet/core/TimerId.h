@@ -0,0 +1,37 @@
+#ifndef LIBNET_TIMERID_H
+#define LIBNET_TIMERID_H
+
+#include "utils/copyable.h"
+#include <cstdint>
+
+namespace libnet {
+
+// 定时器的句柄 : 定时器在所属 loop 的 TimerPool 中的下标与代数
+// 定时器到期 (非重复) 或取消后代数递增，旧句柄随之失效，
+// 对失效句柄的 cancelTimer / updateTimer 什么也不做
+class TimerId : copyable
+{
+public:
+    TimerId() : index_(kInvalidIndex), generation_(0) {}
+    TimerId(uint32_t index, uint32_t generation)
+        : index_(index), generation_(generation) {}
+
+    bool     valid() const { return index_ != kInvalidIndex; }
+    uint32_t index() const { return index_; }
+    uint32_t generation() const { return generation_; }
+
+    bool operator==(const TimerId& rhs) const {
+        return index_ == rhs.index_ && generation_ == rhs.generation_;
+    }
+    bool operator!=(const TimerId& rhs) const { return !(*this == rhs); }
+
+private:
+    static const uint32_t kInvalidIndex = UINT32_MAX;
+
+    uint32_t index_;
+    uint32_t generation_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_TIMERID_H
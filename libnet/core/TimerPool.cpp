@@ -0,0 +1,123 @@
+#include "core/TimerPool.h"
+#include "logger/Logger.h"
+
+#include <algorithm>
+
+using namespace libnet;
+
+TimerPool::TimerPool(size_t maxTimers)
+    : maxChunks_(static_cast<uint32_t>(
+          ((maxTimers < kMaxTimers ? maxTimers : kMaxTimers) + kChunkSize - 1) /
+          kChunkSize)),
+      chunks_(nullptr),
+      tables_(),
+      tableSize_(0),
+      capacity_(0),
+      freeHead_(0),
+      size_(0),
+      growMutex_() {}
+
+TimerPool::~TimerPool() {
+    const uint32_t       numChunks = capacity_.load() / kChunkSize;
+    std::atomic<Timer*>* chunks    = chunks_.load();
+    for (uint32_t i = 0; i < numChunks; ++i) {
+        delete[] chunks[i].load();
+    }
+}
+
+TimerId TimerPool::allocate() {
+    uint32_t index;
+    while (!pop(&index)) {
+        if (!grow()) {
+            return TimerId();
+        }
+    }
+    Timer& timer    = at(index);
+    timer.state_    = Timer::kPending;
+    timer.canceled_ = false;
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return TimerId(index, timer.generation_.load(std::memory_order_relaxed));
+}
+
+void TimerPool::release(Timer* timer) {
+    timer->callback_ = nullptr;
+    timer->state_    = Timer::kFree;
+    timer->generation_.store(
+        timer->generation_.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    push(timer->index_, timer->index_);
+}
+
+bool TimerPool::pop(uint32_t* index) {
+    uint64_t head = freeHead_.load(std::memory_order_acquire);
+    for (;;) {
+        const uint32_t top = static_cast<uint32_t>(head);
+        if (top == 0) {
+            return false;
+        }
+        // 读到的可能已被其他线程弹出，此时标签已变，CAS 失败重试
+        const uint32_t next =
+            at(top - 1).nextFree_.load(std::memory_order_relaxed);
+        const uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+        if (freeHead_.compare_exchange_weak(head, newHead,
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+            *index = top - 1;
+            return true;
+        }
+    }
+}
+
+void TimerPool::push(uint32_t first, uint32_t last) {
+    uint64_t head = freeHead_.load(std::memory_order_relaxed);
+    for (;;) {
+        at(last).nextFree_.store(static_cast<uint32_t>(head),
+                                 std::memory_order_relaxed);
+        const uint64_t newHead = (((head >> 32) + 1) << 32) | (first + 1);
+        if (freeHead_.compare_exchange_weak(head, newHead,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+bool TimerPool::grow() {
+    std::lock_guard<std::mutex> guard(growMutex_);
+    if (static_cast<uint32_t>(freeHead_.load(std::memory_order_acquire)) !=
+        0) {
+        return true;
+    }
+    const uint32_t capacity  = capacity_.load(std::memory_order_relaxed);
+    const uint32_t numChunks = capacity / kChunkSize;
+    if (numChunks >= maxChunks_) {
+        LOG_ERROR << "TimerPool::grow() too many timers " << capacity;
+        return false;
+    }
+    if (numChunks == tableSize_) {
+        // 新表先复制已有的块再发布；旧表可能正被 get 使用，不能释放
+        const uint32_t newSize = std::min(
+            tableSize_ == 0 ? kInitialTableSize : tableSize_ * 2, maxChunks_);
+        ChunkTable table = std::make_unique<std::atomic<Timer*>[]>(newSize);
+        std::atomic<Timer*>* old = chunks_.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < newSize; ++i) {
+            table[i].store(i < numChunks ? old[i].load(std::memory_order_relaxed)
+                                         : nullptr,
+                           std::memory_order_relaxed);
+        }
+        chunks_.store(table.get(), std::memory_order_release);
+        tables_.push_back(std::move(table));
+        tableSize_ = newSize;
+    }
+    Timer* chunk = new Timer[kChunkSize];
+    for (uint32_t i = 0; i < kChunkSize; ++i) {
+        chunk[i].index_ = capacity + i;
+        chunk[i].nextFree_.store(capacity + i + 2, std::memory_order_relaxed);
+    }
+    chunks_.load(std::memory_order_relaxed)[numChunks].store(
+        chunk, std::memory_order_release);
+    capacity_.store(capacity + kChunkSize, std::memory_order_release);
+    push(capacity, capacity + kChunkSize - 1);
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef LIBNET_TIMERPOOL_H
+#define LIBNET_TIMERPOOL_H
+
+#include "core/Timer.h"
+#include "core/TimerId.h"
+#include "utils/noncopyable.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace libnet {
+
+// 每个 TimerQueue 一个的定时器池
+// Timer 按块分配，地址固定、永不释放，空闲的 Timer 串成带标签的无锁栈：
+// 任意线程都可以 allocate (runAfter 等可在其他线程调用)，只有 loop 线程 release
+// 块表满时换成两倍大小的新表，旧表保留到析构，无锁的 get 仍可使用它
+class TimerPool : noncopyable
+{
+public:
+    // 默认只受 TimerId 下标位数的限制
+    explicit TimerPool(size_t maxTimers = kMaxTimers);
+    ~TimerPool();
+
+    // 返回的 Timer 处于 kPending 状态；定时器数达到上限时返回无效的 TimerId。
+    // thread safe
+    TimerId allocate();
+    // 清空回调并递增代数，使旧的 TimerId 失效。只能在 loop 线程中调用
+    void    release(Timer* timer);
+
+    // TimerId 失效 (已释放或下标越界) 时返回 nullptr
+    Timer* get(TimerId id) const {
+        if (id.index() >= capacity_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        Timer* timer = &at(id.index());
+        if (timer->generation_.load(std::memory_order_relaxed) !=
+            id.generation()) {
+            return nullptr;
+        }
+        return timer;
+    }
+
+    // 已分配的定时器数。thread safe
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    static const uint32_t kChunkBits = 12;
+    static const uint32_t kChunkSize = 1u << kChunkBits;
+    // 下标 + 1 存放在空闲栈顶的低 32 位，且 UINT32_MAX 表示无效的 TimerId
+    static const size_t kMaxTimers =
+        static_cast<size_t>(UINT32_MAX >> kChunkBits) << kChunkBits;
+
+private:
+    static const uint32_t kInitialTableSize = 16;  // 64K 个定时器
+
+    using ChunkTable = std::unique_ptr<std::atomic<Timer*>[]>;
+
+    Timer& at(uint32_t index) const {
+        return chunks_.load(std::memory_order_acquire)[index >> kChunkBits]
+            .load(std::memory_order_acquire)[index & (kChunkSize - 1)];
+    }
+    bool     pop(uint32_t* index);
+    // 把 [first, last] 这串已链接的空闲 Timer 压入空闲栈
+    void     push(uint32_t first, uint32_t last);
+    // 达到上限时返回 false
+    bool     grow();
+
+    const uint32_t                    maxChunks_;
+    std::atomic<std::atomic<Timer*>*> chunks_;  // 当前的块表
+    // 用过的所有块表与当前块表的大小，由 growMutex_ 保护
+    std::vector<ChunkTable>           tables_;
+    uint32_t                          tableSize_;
+    std::atomic<uint32_t>             capacity_;
+    // 高 32 位为标签 (每次修改递增，避免 ABA)，低 32 位为栈顶下标 + 1
+    std::atomic<uint64_t>             freeHead_;
+    std::atomic<size_t>               size_;
+    std::mutex                        growMutex_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_TIMERPOOL_H
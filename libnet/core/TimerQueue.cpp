@@ -1,4 +1,5 @@
 #include <cassert>
+#include <cstdlib>
 #include <memory>
 #include <ratio>  // for std::nano::den
 #include <strings.h>
@@ -7,8 +8,10 @@
 #include <utility>
 
 #include "core/EventLoop.h"
+#include "core/TimerHeap.h"
 #include "core/TimerQueue.h"
 #include "core/Timestamp.h"
+#include "core/TimingWheel.h"
 #include "logger/Logger.h"
 
 using namespace libnet;
@@ -55,64 +58,197 @@ void timerfdSet(int fd, Timestamp when) {
 }  // anonymous namespace
 
 TimerQueue::TimerQueue(EventLoop* loop)
-    : loop_(loop), timerfd_(timerfdCreate()), timerChannel_(loop_, timerfd_) {
+    : loop_(loop),
+      timerfd_(timerfdCreate()),
+      timerChannel_(loop_, timerfd_),
+      pool_(),
+      store_(TimerStore::newDefaultTimerStore(clock::now())),
+      expired_(),
+      armedAt_(Timestamp::max()),
+      useTimerfd_(::getenv("LIBNET_NO_TIMERFD") == nullptr) {
     loop_->assertInLoopThread();
     timerChannel_.setReadCallback([this] { handleRead(); });
-    timerChannel_.enableReading();
+    if (useTimerfd_) {
+        timerChannel_.enableReading();
+    }
 }
 
 TimerQueue::~TimerQueue() {
     ::close(timerfd_);
 }
 
-Timer::sptr TimerQueue::addTimer(TimerCallback cb,
-                                 Timestamp     when,
-                                 Nanoseconds   interval,
-                                 bool          repeat) {
-    auto timer = std::make_shared<Timer>(std::move(cb), when, interval, repeat);
-    loop_->runInLoop([=] {
-        timers_.push(timer);
-        // update timerfd expire-time
-        if (timers_.top() == timer) {
-            timerfdSet(timerfd_, when);
+TimerId TimerQueue::addTimer(TimerCallback cb,
+                             Timestamp     when,
+                             Nanoseconds   interval,
+                             bool          repeat) {
+    const TimerId timerId = pool_.allocate();
+    if (!timerId.valid()) {
+        return timerId;  // 定时器数达到上限，回调被丢弃
+    }
+    Timer*        timer   = pool_.get(timerId);
+    timer->callback_      = std::move(cb);
+    timer->when_          = when;
+    timer->interval_      = interval;
+    timer->repeat_        = repeat;
+    loop_->runInLoop([this, timer] {
+        // 加入之前已被取消
+        if (timer->canceled_) {
+            pool_.release(timer);
+            return;
+        }
+        schedule(timer);
+        rearm(timer->when_);
+    });
+    return timerId;
+}
+
+void TimerQueue::cancelTimer(TimerId timerId) {
+    loop_->runInLoop([this, timerId] {
+        Timer* timer = pool_.get(timerId);
+        if (timer == nullptr) {
+            return;
+        }
+        if (timer->state_ == Timer::kScheduled) {
+            store_->remove(timer);
+            pool_.release(timer);
+        }
+        else {
+            // 等待加入或正在执行回调，由 addTimer / handleExpired 释放
+            timer->canceled_ = true;
         }
     });
-    return timer;
 }
 
-void TimerQueue::cancelTimer(Timer::sptr timer) {
-    loop_->runInLoop([timer] {
-        timer->cancel();
-        // delay deletion
-        timer->setTimerCallback(nullptr);
+void TimerQueue::updateTimer(TimerId timerId, Timestamp when) {
+    loop_->runInLoop([this, timerId, when] {
+        Timer* timer = pool_.get(timerId);
+        if (timer == nullptr || timer->canceled_) {
+            return;
+        }
+        switch (timer->state_) {
+            case Timer::kScheduled: store_->update(timer, when); break;
+            case Timer::kRunning:
+                timer->setWhen(when);
+                schedule(timer);
+                break;
+            default: timer->setWhen(when); return;
+        }
+        rearm(when);
     });
 }
 
+Nanoseconds TimerQueue::nextTimeout() {
+    Timestamp next;
+    if (!store_->nextDeadline(&next)) {
+        return Nanoseconds(-1);
+    }
+    auto interval = next - clock::now();
+    if (interval.count() < 0) {
+        return Nanoseconds::zero();
+    }
+    return interval;
+}
+
+void TimerQueue::setTimingWheel(Nanoseconds resolution) {
+    loop_->assertInLoopThread();
+    TimerStore::TimerList timers;
+    store_->takeAll(timers);
+    if (resolution.count() > 0) {
+        store_ = std::make_unique<TimingWheel>(clock::now(), resolution);
+    }
+    else {
+        store_ = std::make_unique<TimerHeap>();
+    }
+    for (Timer* timer : timers) {
+        store_->add(timer);
+    }
+    armedAt_ = Timestamp::max();
+    Timestamp next;
+    if (store_->nextDeadline(&next)) {
+        rearm(next);
+    }
+}
+
+void TimerQueue::setUseTimerfd(bool on) {
+    loop_->assertInLoopThread();
+    if (useTimerfd_ == on) {
+        return;
+    }
+    useTimerfd_ = on;
+    armedAt_    = Timestamp::max();
+    if (on) {
+        timerChannel_.enableReading();
+        Timestamp next;
+        if (store_->nextDeadline(&next)) {
+            rearm(next);
+        }
+    }
+    else {
+        // 已设置的到期时间留在 timerfd 中，重新开启时 handleRead 一并读走
+        timerChannel_.disableAll();
+    }
+}
+
+void TimerQueue::rearm(Timestamp when) {
+    if (!useTimerfd_ || when >= armedAt_) {
+        return;
+    }
+    // 时间轮给出的处理时间可能晚于 when (按 tick 取整)
+    Timestamp next;
+    if (store_->nextDeadline(&next)) {
+        timerfdSet(timerfd_, next);
+        armedAt_ = next;
+    }
+}
+
+void TimerQueue::schedule(Timer* timer) {
+    timer->state_ = Timer::kScheduled;
+    store_->add(timer);
+}
+
 void TimerQueue::handleRead() {
     loop_->assertInLoopThread();
     timerfdRead(timerfd_);
+    handleExpired();
+}
 
+void TimerQueue::handleExpired() {
+    loop_->assertInLoopThread();
     Timestamp now(clock::now());
 
-    while (!timers_.empty()) {
-        auto timer = timers_.top();
-        if (!timer->expired(now)) {
-            break;
+    store_->takeExpired(now, expired_);
+    // 已取出的定时器可能被前面的回调取消或修改
+    for (Timer* timer : expired_) {
+        timer->state_ = Timer::kRunning;
+    }
+    for (Timer* timer : expired_) {
+        if (timer->state_ != Timer::kRunning) {
+            continue;
         }
-
-        if (!timer->canceled()) {
+        if (!timer->canceled_) {
             timer->run();
         }
-
-        timers_.pop();
-
-        if (!timer->canceled() && timer->repeat()) {
+        if (timer->state_ != Timer::kRunning) {
+            // 回调中 updateTimer 过，已重新加入
+            continue;
+        }
+        if (timer->canceled_) {
+            pool_.release(timer);
+        }
+        else if (timer->repeat_) {
             timer->restart();
-            timers_.emplace(std::move(timer));
+            schedule(timer);
+        }
+        else {
+            pool_.release(timer);
         }
-        // true delete
     }
+    expired_.clear();
+
     // update timerfd expire-time
-    if (!timers_.empty())
-        timerfdSet(timerfd_, timers_.top()->when());
+    armedAt_ = Timestamp::max();
+    Timestamp next;
+    if (store_->nextDeadline(&next)) {
+        rearm(next);
+    }
 }
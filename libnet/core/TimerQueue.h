@@ -3,62 +3,71 @@
 
 #include "core/Channel.h"
 #include "core/Timer.h"
+#include "core/TimerId.h"
+#include "core/TimerPool.h"
+#include "core/TimerStore.h"
 #include "core/Timestamp.h"
 #include <any>
 #include <chrono>
 #include <cstdint>
-#include <deque>
 #include <memory>
-#include <queue>
 #include <vector>
 
 namespace libnet {
 
-struct TimerCmp
-{
-    bool operator()(Timer::sptr lhs, Timer::sptr rhs) {
-        return lhs->when() > rhs->when();
-    }
-};
-
 class TimerQueue : noncopyable
 {
 public:
     explicit TimerQueue(EventLoop* loop);
     ~TimerQueue();
 
-    Timer::sptr addTimer(TimerCallback cb,
-                         Timestamp     when,
-                         Nanoseconds   interval = Milliseconds::zero(),
-                         bool          repeat   = false);
+    // 定时器数达到 TimerPool 的上限时返回无效的 TimerId。thread safe
+    TimerId addTimer(TimerCallback cb,
+                     Timestamp     when,
+                     Nanoseconds   interval = Milliseconds::zero(),
+                     bool          repeat   = false);
+
+    void cancelTimer(TimerId timerId);
 
-    void cancelTimer(Timer::sptr timer);
+    // 修改到期时间，正在执行回调的定时器会重新加入
+    void updateTimer(TimerId timerId, Timestamp when);
 
-    void updateTimer(Timer::sptr timer, Timestamp when);
+    // 尚未释放的定时器数 (含等待加入的)
+    size_t size() const { return pool_.size(); }
 
-    int64_t nextTimeout() const {
-        if (timers_.empty()) {
-            return 0;
-        }
-        auto interval = timers_.top()->when() - clock::now();
-        if (interval.count() < 0) {
-            return 0;
-        }
-        return std::chrono::duration_cast<Milliseconds>(interval).count();
-    }
+    // 距下一次需要处理定时器还有多久，没有定时器时返回 -1
+    Nanoseconds nextTimeout();
+
+    // resolution > 0 时改用该精度的分层时间轮，0 时改用小根堆，
+    // 已有的定时器随之迁移。只能在 loop 线程中调用
+    void setTimingWheel(Nanoseconds resolution);
+    const TimerStore& store() const { return *store_; }
+
+    // 关闭 timerfd 后不再调用 timerfd_settime，由 EventLoop 以 nextTimeout()
+    // 作为 poll 的超时，并在分发完 I/O 事件后调用 handleExpired()。
+    // 默认开启，设置环境变量 LIBNET_NO_TIMERFD 后默认关闭
+    void setUseTimerfd(bool on);
+    bool useTimerfd() const { return useTimerfd_; }
+
+    // 执行所有已到期的定时器
+    void handleExpired();
 
     int timerfd() const { return timerfd_; }
 
 private:
-    using TimerHeap =
-        std::priority_queue<Timer::sptr, std::vector<Timer::sptr>, TimerCmp>;
-
     void handleRead();
+    void schedule(Timer* timer);
+    // 新的到期时间早于 timerfd 上设置的时间时重新设置
+    void rearm(Timestamp when);
 
-    EventLoop* loop_;
-    const int  timerfd_;
-    Channel    timerChannel_;
-    TimerHeap  timers_;
+    EventLoop*            loop_;
+    const int             timerfd_;
+    Channel               timerChannel_;
+    TimerPool             pool_;  // 须在 store_ 之前构造、之后析构
+    TimerStore::ptr       store_;
+    TimerStore::TimerList expired_;
+    Timestamp             armedAt_;  // timerfd 上设置的到期时间
+    bool                  useTimerfd_;
 };
 
 }  // namespace libnet
@@ -0,0 +1,18 @@
+#include "core/TimerStore.h"
+#include "core/TimerHeap.h"
+#include "core/TimingWheel.h"
+
+#include <cstdlib>
+
+using namespace libnet;
+
+TimerStore::ptr TimerStore::newDefaultTimerStore(Timestamp now) {
+    const char* wheel = ::getenv("LIBNET_TIMER_WHEEL");
+    if (wheel != nullptr) {
+        const long micros = ::atol(wheel);
+        return std::make_unique<TimingWheel>(
+            now, micros > 0 ? Nanoseconds(Microseconds(micros))
+                            : TimingWheel::kDefaultResolution);
+    }
+    return std::make_unique<TimerHeap>();
+}
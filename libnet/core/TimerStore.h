@@ -0,0 +1,46 @@
+#ifndef LIBNET_TIMERSTORE_H
+#define LIBNET_TIMERSTORE_H
+
+#include "core/Timer.h"
+#include "core/Timestamp.h"
+#include "utils/noncopyable.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace libnet {
+
+// TimerQueue 中按到期时间组织定时器的容器，只能在 loop 线程中使用
+// 默认使用小根堆 TimerHeap，设置环境变量 LIBNET_TIMER_WHEEL 后使用分层时间轮
+// TimingWheel (变量的值为精度，单位微秒，缺省 1000)
+class TimerStore : noncopyable
+{
+public:
+    using ptr       = std::unique_ptr<TimerStore>;
+    using TimerList = std::vector<Timer*>;
+
+    virtual ~TimerStore() = default;
+
+    static ptr newDefaultTimerStore(Timestamp now);
+
+    // 按 timer->when() 加入，timer 不能已在其中
+    virtual void add(Timer* timer) = 0;
+    // 移除尚未到期的 timer，不在其中时什么也不做
+    virtual void remove(Timer* timer) = 0;
+    // 修改到期时间，timer 不在其中时加入
+    virtual void update(Timer* timer, Timestamp when) = 0;
+
+    // 下一次需要处理的时间，不晚于最早的到期时间；没有定时器时返回 false
+    virtual bool nextDeadline(Timestamp* when) = 0;
+    // 取出所有不晚于 now 到期的定时器，追加到 expired
+    virtual void takeExpired(Timestamp now, TimerList& expired) = 0;
+    // 取出全部定时器，用于切换实现
+    virtual void takeAll(TimerList& timers) = 0;
+
+    virtual size_t      size() const = 0;
+    virtual const char* name() const = 0;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_TIMERSTORE_H
@@ -0,0 +1,246 @@
+#include "core/TimingWheel.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace libnet;
+
+namespace {
+
+int slotBase(int level) {
+    return level == 0 ? 0 : 256 + (level - 1) * 64;
+}
+
+}  // anonymous namespace
+
+TimingWheel::TimingWheel(Timestamp now, Nanoseconds resolution)
+    : base_(now),
+      resolution_(std::max(resolution, Nanoseconds(1))),
+      current_(0),
+      size_(0),
+      slots_(),
+      occupied_() {
+    static_assert(kLevel0Slots == 256 && kLevelSlots == 64,
+                  "slotBase() assumes 256 + 64 * n slots");
+}
+
+TimingWheel::~TimingWheel() {
+    TimerList timers;
+    takeAll(timers);
+}
+
+void TimingWheel::add(Timer* timer) {
+    assert(timer->slot_ < 0);
+    link(timer);
+    ++size_;
+}
+
+void TimingWheel::remove(Timer* timer) {
+    if (timer->slot_ < 0) {
+        return;
+    }
+    unlink(timer);
+    --size_;
+}
+
+void TimingWheel::update(Timer* timer, Timestamp when) {
+    if (timer->slot_ < 0) {
+        timer->setWhen(when);
+        add(timer);
+        return;
+    }
+    unlink(timer);
+    timer->setWhen(when);
+    link(timer);
+}
+
+bool TimingWheel::nextDeadline(Timestamp* when) {
+    const int64_t tick = nextEventTick();
+    if (tick < 0) {
+        return false;
+    }
+    *when = base_ + tick * resolution_;
+    return true;
+}
+
+void TimingWheel::takeExpired(Timestamp now, TimerList& expired) {
+    const int64_t target = tickOf(now, false);
+    for (;;) {
+        const int64_t tick = nextEventTick();
+        if (tick < 0 || tick > target) {
+            break;
+        }
+        current_ = tick;
+        // 到达高层槽的起点，自顶向下把其中的定时器下放
+        for (int level = kNumLevels; level >= 1; --level) {
+            if ((tick & ((int64_t(1) << shift(level)) - 1)) == 0) {
+                cascade(level == kNumLevels
+                            ? kOverflowSlot
+                            : slotBase(level) +
+                                  static_cast<int>((tick >> shift(level)) &
+                                                   (kLevelSlots - 1)));
+            }
+        }
+
+        const int slot  = static_cast<int>(tick & (kLevel0Slots - 1));
+        Timer*    timer = slots_[slot].head;
+        slots_[slot]    = Slot();
+        occupied_[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+        while (timer != nullptr) {
+            Timer* next  = timer->next_;
+            timer->prev_ = nullptr;
+            timer->next_ = nullptr;
+            timer->slot_ = -1;
+            --size_;
+            expired.push_back(timer);
+            timer = next;
+        }
+        current_ = tick + 1;
+    }
+    // 中间没有非空的槽，直接跳过
+    current_ = std::max(current_, target + 1);
+}
+
+void TimingWheel::takeAll(TimerList& timers) {
+    for (int slot = 0; slot < kNumSlots; ++slot) {
+        Timer* timer = slots_[slot].head;
+        while (timer != nullptr) {
+            Timer* next  = timer->next_;
+            timer->prev_ = nullptr;
+            timer->next_ = nullptr;
+            timer->slot_ = -1;
+            timers.push_back(timer);
+            timer = next;
+        }
+        slots_[slot] = Slot();
+    }
+    std::fill(std::begin(occupied_), std::end(occupied_), 0);
+    size_ = 0;
+}
+
+int64_t TimingWheel::tickOf(Timestamp when, bool roundUp) const {
+    const int64_t nanos = (when - base_).count();
+    if (nanos <= 0) {
+        return 0;
+    }
+    const int64_t res = resolution_.count();
+    return roundUp ? (nanos + res - 1) / res : nanos / res;
+}
+
+int TimingWheel::slotFor(int64_t expiry) const {
+    for (int level = 0; level < kNumLevels; ++level) {
+        if ((expiry >> shift(level + 1)) == (current_ >> shift(level + 1))) {
+            const int mask = level == 0 ? kLevel0Slots - 1 : kLevelSlots - 1;
+            return slotBase(level) +
+                   static_cast<int>((expiry >> shift(level)) & mask);
+        }
+    }
+    return kOverflowSlot;
+}
+
+void TimingWheel::link(Timer* timer) {
+    const int64_t expiry = std::max(tickOf(timer->when(), true), current_);
+    const int     slot   = slotFor(expiry);
+    Slot&         list   = slots_[slot];
+    timer->prev_         = list.tail;
+    timer->next_         = nullptr;
+    if (list.tail != nullptr) {
+        list.tail->next_ = timer;
+    }
+    else {
+        list.head = timer;
+    }
+    list.tail    = timer;
+    timer->slot_ = slot;
+    if (slot != kOverflowSlot) {
+        occupied_[slot / 64] |= uint64_t(1) << (slot % 64);
+    }
+}
+
+void TimingWheel::unlink(Timer* timer) {
+    assert(timer->slot_ >= 0);
+    const int slot = timer->slot_;
+    Slot&     list = slots_[slot];
+    if (timer->prev_ != nullptr) {
+        timer->prev_->next_ = timer->next_;
+    }
+    else {
+        list.head = timer->next_;
+    }
+    if (timer->next_ != nullptr) {
+        timer->next_->prev_ = timer->prev_;
+    }
+    else {
+        list.tail = timer->prev_;
+    }
+    if (list.head == nullptr && slot != kOverflowSlot) {
+        occupied_[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    }
+    timer->prev_ = nullptr;
+    timer->next_ = nullptr;
+    timer->slot_ = -1;
+}
+
+void TimingWheel::cascade(int slot) {
+    Timer* timer = slots_[slot].head;
+    slots_[slot] = Slot();
+    if (slot != kOverflowSlot) {
+        occupied_[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    }
+    while (timer != nullptr) {
+        Timer* next = timer->next_;
+        link(timer);
+        timer = next;
+    }
+}
+
+int64_t TimingWheel::nextEventTick() const {
+    // 恰好位于高层槽的起点而该槽尚未下放
+    for (int level = kNumLevels - 1; level >= 1; --level) {
+        if ((current_ & ((int64_t(1) << shift(level)) - 1)) == 0) {
+            const int pos = static_cast<int>((current_ >> shift(level)) &
+                                             (kLevelSlots - 1));
+            if (findNext(level, pos) == pos) {
+                return current_;
+            }
+        }
+    }
+    if ((current_ & ((int64_t(1) << shift(kNumLevels)) - 1)) == 0 &&
+        slots_[kOverflowSlot].head != nullptr) {
+        return current_;
+    }
+
+    const int pos0 = static_cast<int>(current_ & (kLevel0Slots - 1));
+    const int slot = findNext(0, pos0);
+    if (slot >= 0) {
+        return (current_ & ~int64_t(kLevel0Slots - 1)) + slot;
+    }
+    for (int level = 1; level < kNumLevels; ++level) {
+        const int pos = static_cast<int>((current_ >> shift(level)) &
+                                         (kLevelSlots - 1));
+        const int next = findNext(level, pos + 1);
+        if (next >= 0) {
+            const int64_t block = current_ >> shift(level + 1)
+                                                << shift(level + 1);
+            return block + (int64_t(next) << shift(level));
+        }
+    }
+    if (slots_[kOverflowSlot].head != nullptr) {
+        return ((current_ >> shift(kNumLevels)) + 1) << shift(kNumLevels);
+    }
+    return -1;
+}
+
+int TimingWheel::findNext(int level, int from) const {
+    const int base  = slotBase(level);
+    const int count = level == 0 ? kLevel0Slots : kLevelSlots;
+    for (int i = from; i < count;) {
+        const int      bit  = base + i;
+        const uint64_t word = occupied_[bit / 64] >> (bit % 64);
+        if (word != 0) {
+            return i + __builtin_ctzll(word);
+        }
+        i += 64 - bit % 64;
+    }
+    return -1;
+}
@@ -0,0 +1,80 @@
+#ifndef LIBNET_TIMINGWHEEL_H
+#define LIBNET_TIMINGWHEEL_H
+
+#include "core/TimerStore.h"
+#include <cstdint>
+
+namespace libnet {
+
+// 分层时间轮，加入、取消、修改时间均为 O(1)，定时器挂在槽的侵入式链表上
+// 第 0 层 256 个槽，每槽一个 tick (精度)；第 1~4 层各 64 个槽，每层的槽宽是
+// 下一层整圈的长度，共覆盖 2^32 个 tick，更远的定时器放入溢出链表。
+// 定时器按到期 tick 与当前 tick 最高的不同位所在的层入槽，时间推进到
+// 高层槽的起点时把其中的定时器下放到低层。
+// 到期时间向上取整到 tick，定时器不会提前触发，最多推迟一个精度
+class TimingWheel : public TimerStore
+{
+public:
+    static constexpr Nanoseconds kDefaultResolution = 1ms;
+
+    explicit TimingWheel(Timestamp   now,
+                         Nanoseconds resolution = kDefaultResolution);
+    ~TimingWheel() override;
+
+    void add(Timer* timer) override;
+    void remove(Timer* timer) override;
+    void update(Timer* timer, Timestamp when) override;
+
+    bool nextDeadline(Timestamp* when) override;
+    void takeExpired(Timestamp now, TimerList& expired) override;
+    void takeAll(TimerList& timers) override;
+
+    size_t      size() const override { return size_; }
+    const char* name() const override { return "wheel"; }
+
+    Nanoseconds resolution() const { return resolution_; }
+
+private:
+    static const int kLevel0Bits  = 8;
+    static const int kLevelBits   = 6;
+    static const int kNumLevels   = 5;
+    static const int kLevel0Slots = 1 << kLevel0Bits;
+    static const int kLevelSlots  = 1 << kLevelBits;
+    static const int kOverflowSlot =
+        kLevel0Slots + (kNumLevels - 1) * kLevelSlots;
+    static const int kNumSlots = kOverflowSlot + 1;
+    static const int kNumWords = kOverflowSlot / 64;
+
+    struct Slot
+    {
+        Timer* head = nullptr;
+        Timer* tail = nullptr;
+    };
+
+    // 第 level 层每个槽的宽度为 2^shift(level) 个 tick
+    static int shift(int level) {
+        return level == 0 ? 0 : kLevel0Bits + (level - 1) * kLevelBits;
+    }
+
+    int64_t tickOf(Timestamp when, bool roundUp) const;
+    int     slotFor(int64_t expiry) const;
+    void    link(Timer* timer);
+    void    unlink(Timer* timer);
+    // 把槽中的定时器按当前 tick 重新入槽
+    void    cascade(int slot);
+    // 下一个需要处理的 tick，没有定时器时返回 -1
+    int64_t nextEventTick() const;
+    int     findNext(int level, int from) const;
+
+    const Timestamp   base_;
+    const Nanoseconds resolution_;
+    int64_t           current_;  // 第一个尚未处理的 tick
+    size_t            size_;
+    Slot              slots_[kNumSlots];
+    // 非空槽的位图，第 0 层占 4 个字，其余每层 1 个字
+    uint64_t          occupied_[kNumWords];
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_TIMINGWHEEL_H
@@ -0,0 +1,624 @@
+#include "core/UringPoller.h"
+#include "core/Channel.h"
+#include "core/EventLoop.h"
+#include "logger/Logger.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <ratio>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace libnet;
+
+const unsigned UringPoller::kSqEntries;
+const unsigned UringPoller::kCqEntries;
+const unsigned UringPoller::kRecvBlocks;
+const uint16_t UringPoller::kBufferGroup;
+
+namespace {
+
+int ioUringSetup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int         fd,
+                 unsigned    toSubmit,
+                 unsigned    minComplete,
+                 unsigned    flags,
+                 const void* arg,
+                 size_t      argSize) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit,
+                                      minComplete, flags, arg, argSize));
+}
+
+int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned numArgs) {
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_register, fd, opcode, arg, numArgs));
+}
+
+template <typename T>
+T* ringAt(void* ring, unsigned offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+}  // anonymous namespace
+
+UringPoller::UringPoller(EventLoop* loop)
+    : Poller(loop),
+      ringFd_(-1),
+      ring_(MAP_FAILED),
+      ringSize_(0),
+      sqesSize_(0),
+      sqMask_(0),
+      sqEntries_(0),
+      cqMask_(0),
+      sqHead_(nullptr),
+      sqTail_(nullptr),
+      sqArray_(nullptr),
+      cqHead_(nullptr),
+      cqTail_(nullptr),
+      sqes_(static_cast<io_uring_sqe*>(MAP_FAILED)),
+      cqes_(nullptr),
+      entries_(1024),
+      active_(nullptr),
+      batch_(0),
+      bufRing_(nullptr),
+      recvBlocks_(nullptr),
+      bufTail_(0) {
+    if (!setup()) {
+        unmapRings();
+        if (ringFd_ >= 0) {
+            ::close(ringFd_);
+            ringFd_ = -1;
+        }
+        return;
+    }
+    completions_.reserve(kCqEntries);
+    completionChannel_ = std::make_unique<Channel>(loop, ringFd_);
+    completionChannel_->setReadCallback([this] { dispatchCompletions(); });
+}
+
+UringPoller::~UringPoller() {
+    if (ringFd_ < 0) {
+        return;
+    }
+    drainOps();
+    ::close(ringFd_);
+    unmapRings();
+}
+
+bool UringPoller::setup() {
+    struct io_uring_params params;
+    ::memset(&params, 0, sizeof(params));
+    // 只有 loop 线程提交，完成事件的 task work 也推迟到等待时统一处理 (6.1)
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL |
+                   IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    params.cq_entries = kCqEntries;
+    ringFd_           = ioUringSetup(kSqEntries, &params);
+    const bool deferTaskrun = ringFd_ >= 0;
+    if (ringFd_ < 0 && errno == EINVAL) {
+        ::memset(&params, 0, sizeof(params));
+        params.flags      = IORING_SETUP_CQSIZE;
+        params.cq_entries = kCqEntries;
+        ringFd_           = ioUringSetup(kSqEntries, &params);
+    }
+    if (ringFd_ < 0) {
+        LOG_SYSERR << "UringPoller::io_uring_setup()";
+        return false;
+    }
+    // 多次触发的 POLL_ADD 与 IORING_FEAT_RSRC_TAGS 同在 5.13 加入，
+    // 等待超时使用 IORING_ENTER_EXT_ARG (5.11)
+    const unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP |
+                              IORING_FEAT_EXT_ARG | IORING_FEAT_RSRC_TAGS;
+    if ((params.features & required) != required) {
+        LOG_WARN << "UringPoller kernel lacks required io_uring features";
+        return false;
+    }
+
+    ringSize_ =
+        std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                 params.cq_off.cqes +
+                     params.cq_entries * sizeof(struct io_uring_cqe));
+    ring_ = ::mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+    if (ring_ == MAP_FAILED) {
+        LOG_SYSERR << "UringPoller::mmap() ring";
+        return false;
+    }
+    sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_     = static_cast<io_uring_sqe*>(
+        ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+        LOG_SYSERR << "UringPoller::mmap() sqes";
+        return false;
+    }
+
+    sqHead_    = ringAt<unsigned>(ring_, params.sq_off.head);
+    sqTail_    = ringAt<unsigned>(ring_, params.sq_off.tail);
+    sqArray_   = ringAt<unsigned>(ring_, params.sq_off.array);
+    sqMask_    = *ringAt<unsigned>(ring_, params.sq_off.ring_mask);
+    sqEntries_ = params.sq_entries;
+    cqHead_    = ringAt<unsigned>(ring_, params.cq_off.head);
+    cqTail_    = ringAt<unsigned>(ring_, params.cq_off.tail);
+    cqMask_    = *ringAt<unsigned>(ring_, params.cq_off.ring_mask);
+    cqes_      = ringAt<io_uring_cqe>(ring_, params.cq_off.cqes);
+
+    // 多次触发的 recv 在 6.0 加入，以 DEFER_TASKRUN (6.1) 是否可用来判断；
+    // 不支持时只提供就绪通知
+    if (!deferTaskrun || !setupBufferRing()) {
+        LOG_WARN << "UringPoller completion mode unavailable";
+    }
+    return true;
+}
+
+bool UringPoller::setupBufferRing() {
+    const size_t ringBytes = kRecvBlocks * sizeof(struct io_uring_buf);
+    void*        ring = ::mmap(nullptr, ringBytes, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        LOG_SYSERR << "UringPoller::mmap() buffer ring";
+        return false;
+    }
+    void* blocks = ::mmap(nullptr, kRecvBlocks * kRecvBlockSize,
+                          PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                          -1, 0);
+    if (blocks == MAP_FAILED) {
+        LOG_SYSERR << "UringPoller::mmap() recv blocks";
+        ::munmap(ring, ringBytes);
+        return false;
+    }
+    struct io_uring_buf_reg reg;
+    ::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr    = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = kRecvBlocks;
+    reg.bgid         = kBufferGroup;
+    if (ioUringRegister(ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+        LOG_SYSERR << "UringPoller::io_uring_register() buffer ring";
+        ::munmap(blocks, kRecvBlocks * kRecvBlockSize);
+        ::munmap(ring, ringBytes);
+        return false;
+    }
+    bufRing_    = static_cast<io_uring_buf_ring*>(ring);
+    recvBlocks_ = static_cast<char*>(blocks);
+    for (unsigned bid = 0; bid < kRecvBlocks; ++bid) {
+        recycleBlock(bid);
+    }
+    return true;
+}
+
+void UringPoller::unmapRings() {
+    if (sqes_ != MAP_FAILED) {
+        ::munmap(sqes_, sqesSize_);
+        sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+    }
+    if (ring_ != MAP_FAILED) {
+        ::munmap(ring_, ringSize_);
+        ring_ = MAP_FAILED;
+    }
+    if (bufRing_ != nullptr) {
+        ::munmap(bufRing_, kRecvBlocks * sizeof(struct io_uring_buf));
+        ::munmap(recvBlocks_, kRecvBlocks * kRecvBlockSize);
+        bufRing_    = nullptr;
+        recvBlocks_ = nullptr;
+    }
+}
+
+io_uring_sqe* UringPoller::getSqe() {
+    const unsigned tail = *sqTail_;
+    if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) == sqEntries_) {
+        // SQ 已满，先提交已有的 SQE，没有 SQPOLL 时提交后 SQ 即为空
+        ++stats_.ctlCalls;
+        if (ioUringEnter(ringFd_, sqEntries_, 0, 0, nullptr, 0) == -1) {
+            LOG_SYSFATAL << "UringPoller::getSqe() submit";
+        }
+    }
+    const unsigned index = tail & sqMask_;
+    io_uring_sqe*  sqe   = &sqes_[index];
+    ::memset(sqe, 0, sizeof(*sqe));
+    sqArray_[index] = index;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+    return sqe;
+}
+
+int UringPoller::wait(Nanoseconds timeout) {
+    const unsigned pending =
+        *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    unsigned                      flags   = IORING_ENTER_GETEVENTS;
+    const void*                   arg     = nullptr;
+    size_t                        argSize = 0;
+    struct __kernel_timespec      ts;
+    struct io_uring_getevents_arg eventsArg;
+    const int64_t                 ns = timeout.count();
+    if (ns > 0) {
+        ts.tv_sec  = ns / std::nano::den;
+        ts.tv_nsec = ns % std::nano::den;
+        ::memset(&eventsArg, 0, sizeof(eventsArg));
+        eventsArg.ts = reinterpret_cast<uint64_t>(&ts);
+        flags |= IORING_ENTER_EXT_ARG;
+        arg     = &eventsArg;
+        argSize = sizeof(eventsArg);
+    }
+    return ioUringEnter(ringFd_, pending, ns == 0 ? 0 : 1, flags, arg,
+                        argSize);
+}
+
+void UringPoller::poll(ChannelList& activeChannels, Nanoseconds timeout) {
+    loop_->assertInLoopThread();
+    // 上一批已触发的单次 poll 重新注册，与本次等待一起提交
+    for (int fd : rearm_) {
+        Entry& entry = entries_[fd];
+        if (entry.channel != nullptr && !entry.armed) {
+            arm(fd, entry);
+        }
+    }
+    rearm_.clear();
+
+    ++stats_.pollCalls;
+    if (wait(timeout) == -1) {
+        if (errno != EINTR && errno != ETIME && errno != EBUSY)
+            LOG_SYSERR << "UringPoller::poll()";
+    }
+    reapCompletions(activeChannels);
+    if (activeChannels.empty()) {
+        LOG_TRACE << "nothing happended";
+    }
+    else {
+        LOG_TRACE << activeChannels.size() << " events happend";
+    }
+}
+
+void UringPoller::reapCompletions(ChannelList& activeChannels) {
+    ++batch_;
+    active_              = &activeChannels;
+    const size_t   first = activeChannels.size();
+    unsigned       head  = *cqHead_;
+    const unsigned tail  = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    // 一批最多 kCqEntries 个 CQE (加上 completionChannel_)，一次预留到上限，
+    // 之后不再随批次大小扩容 (只有 CQ 溢出时例外)
+    activeChannels.reserve(first + kCqEntries + 1);
+    for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = cqes_[head & cqMask_];
+        if (cqe.user_data == kIgnoreTag) {
+            continue;
+        }
+        if (cqe.user_data & kOpTag) {
+            completions_.push_back({ cqe.user_data, cqe.res, cqe.flags });
+            continue;
+        }
+        const int      fd         = static_cast<int>(cqe.user_data & 0xffffffff);
+        const uint32_t generation = static_cast<uint32_t>(cqe.user_data >> 32);
+        if (static_cast<size_t>(fd) >= entries_.size()) {
+            continue;
+        }
+        Entry& entry = entries_[fd];
+        // 已取消或已被新的注册替换的 poll
+        if (entry.channel == nullptr ||
+            (entry.generation & 0x7fffffff) != generation || !entry.armed) {
+            continue;
+        }
+        if (cqe.res < 0) {
+            entry.armed = false;
+            errno       = -cqe.res;
+            LOG_SYSERR << "UringPoller::poll() fd=" << fd;
+            continue;
+        }
+        if (!entry.multishot || !(cqe.flags & IORING_CQE_F_MORE)) {
+            // poll 已结束，事件处理完后重新注册
+            entry.armed = false;
+            rearm_.push_back(fd);
+        }
+        // 多次触发的 poll 在同一批中可能有多个完成事件，合并为一次回调
+        if (entry.batch == batch_) {
+            entry.revents |= static_cast<uint32_t>(cqe.res);
+        }
+        else {
+            entry.batch       = batch_;
+            entry.revents     = static_cast<uint32_t>(cqe.res);
+            entry.activeIndex = static_cast<uint32_t>(activeChannels.size());
+            activeChannels.push_back(entry.channel);
+        }
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+    for (size_t i = first; i < activeChannels.size(); ++i) {
+        Channel* channel = activeChannels[i];
+        channel->setRevents(static_cast<int>(entries_[channel->fd()].revents));
+    }
+    if (!completions_.empty()) {
+        stats_.completions += completions_.size();
+        completionChannel_->setRevents(EPOLLIN);
+        activeChannels.push_back(completionChannel_.get());
+    }
+}
+
+void UringPoller::updateChannel(Channel* channel) {
+    loop_->assertInLoopThread();
+    const int fd = channel->fd();
+    if (static_cast<size_t>(fd) >= entries_.size()) {
+        entries_.resize(std::max(static_cast<size_t>(fd) + 1,
+                                 2 * entries_.size()));
+    }
+    Entry& entry = entries_[fd];
+    if (!channel->polling()) {
+        assert(!channel->isNoneEvents());
+        channel->setPolling(true);
+        if (entry.armed) {
+            disarm(fd, entry);
+        }
+        ++entry.generation;
+    }
+    else if (channel->isNoneEvents()) {
+        channel->setPolling(false);
+        // 本批中尚未分发的事件不再交给该 channel
+        if (entry.batch == batch_ && active_ != nullptr &&
+            entry.activeIndex < active_->size() &&
+            (*active_)[entry.activeIndex] == channel) {
+            (*active_)[entry.activeIndex] = nullptr;
+        }
+    }
+
+    const uint32_t events    = static_cast<uint32_t>(channel->events());
+    const bool     multishot = channel->edgeTriggered();
+    if (entry.channel == channel && entry.events == events &&
+        entry.multishot == multishot && (entry.armed || !multishot)) {
+        ++stats_.ctlAvoided;  // 关注的事件没有变化
+        return;
+    }
+    if (entry.armed) {
+        disarm(fd, entry);
+    }
+    entry.channel   = channel->isNoneEvents() ? nullptr : channel;
+    entry.events    = events;
+    entry.multishot = multishot;
+    if (entry.channel != nullptr) {
+        arm(fd, entry);
+    }
+}
+
+void UringPoller::arm(int fd, Entry& entry) {
+    io_uring_sqe* sqe  = getSqe();
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = fd;
+    sqe->poll32_events = entry.events;
+    if (entry.multishot) {
+        sqe->len = IORING_POLL_ADD_MULTI;
+    }
+    sqe->user_data = userData(fd, entry.generation);
+    entry.armed    = true;
+    ++stats_.ctlAvoided;  // 随下一次等待提交
+}
+
+void UringPoller::disarm(int fd, Entry& entry) {
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode       = IORING_OP_POLL_REMOVE;
+    sqe->addr         = userData(fd, entry.generation);
+    sqe->user_data    = kIgnoreTag;
+    entry.armed       = false;
+    // 被取消的 poll 可能已经产生了完成事件，之后一律丢弃
+    ++entry.generation;
+    ++stats_.ctlAvoided;
+}
+
+io_uring_sqe* UringPoller::prepareOp(int                          fd,
+                                     OpKind                       kind,
+                                     CompletionHandler*           handler,
+                                     const std::shared_ptr<void>& holder) {
+    loop_->assertInLoopThread();
+    assert(completionMode());
+    uint32_t index;
+    if (freeOps_.empty()) {
+        index = static_cast<uint32_t>(ops_.size());
+        ops_.emplace_back();
+    }
+    else {
+        index = freeOps_.back();
+        freeOps_.pop_back();
+    }
+    Op& op       = ops_[index];
+    op.handler   = handler;
+    op.holder    = holder;
+    op.kind      = kind;
+    op.inUse     = true;
+    op.cancelled = false;
+
+    io_uring_sqe* sqe = getSqe();
+    sqe->fd           = fd;
+    sqe->user_data    = opData(index, op.generation);
+    return sqe;
+}
+
+Poller::OpId UringPoller::acceptMultishot(int                          fd,
+                                          CompletionHandler*           handler,
+                                          const std::shared_ptr<void>& holder) {
+    if (!completionMode()) {
+        return 0;
+    }
+    io_uring_sqe* sqe = prepareOp(fd, kAccept, handler, holder);
+    sqe->opcode       = IORING_OP_ACCEPT;
+    sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    return sqe->user_data;
+}
+
+Poller::OpId UringPoller::recvMultishot(int                          fd,
+                                        CompletionHandler*           handler,
+                                        const std::shared_ptr<void>& holder) {
+    if (!completionMode()) {
+        return 0;
+    }
+    io_uring_sqe* sqe = prepareOp(fd, kRecv, handler, holder);
+    sqe->opcode       = IORING_OP_RECV;
+    sqe->ioprio       = IORING_RECV_MULTISHOT;
+    sqe->flags        = IOSQE_BUFFER_SELECT;
+    sqe->buf_group    = kBufferGroup;
+    return sqe->user_data;
+}
+
+Poller::OpId UringPoller::sendMsg(int                          fd,
+                                  const struct msghdr*         msg,
+                                  CompletionHandler*           handler,
+                                  const std::shared_ptr<void>& holder) {
+    if (!completionMode()) {
+        return 0;
+    }
+    io_uring_sqe* sqe = prepareOp(fd, kSend, handler, holder);
+    sqe->opcode       = IORING_OP_SENDMSG;
+    sqe->addr         = reinterpret_cast<uint64_t>(msg);
+    sqe->len          = 1;
+    sqe->msg_flags    = MSG_NOSIGNAL;
+    return sqe->user_data;
+}
+
+UringPoller::Op* UringPoller::findOp(OpId id) {
+    const uint32_t index = static_cast<uint32_t>(id);
+    if ((id & kOpTag) == 0 || index >= ops_.size()) {
+        return nullptr;
+    }
+    Op& op = ops_[index];
+    if (!op.inUse || opData(index, op.generation) != id) {
+        return nullptr;
+    }
+    return &op;
+}
+
+void UringPoller::cancel(OpId id) {
+    loop_->assertInLoopThread();
+    Op* op = findOp(id);
+    if (op == nullptr || op->cancelled) {
+        return;
+    }
+    op->cancelled     = true;
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+    sqe->addr         = id;
+    sqe->user_data    = kIgnoreTag;
+}
+
+void UringPoller::abandon(OpId id) {
+    Op* op = findOp(id);
+    if (op != nullptr) {
+        op->handler = nullptr;
+        cancel(id);
+    }
+}
+
+void UringPoller::releaseOp(uint32_t index) {
+    Op& op = ops_[index];
+    op.handler = nullptr;
+    op.holder.reset();
+    op.inUse = false;
+    ++op.generation;
+    freeOps_.push_back(index);
+}
+
+void UringPoller::dispatchCompletions() {
+    // handler 中可能提交新的操作，ops_ 随之扩容，不持有其中的引用
+    for (size_t i = 0; i < completions_.size(); ++i) {
+        const Completion c     = completions_[i];
+        const uint32_t   index = static_cast<uint32_t>(c.userData);
+        const bool       more  = (c.flags & IORING_CQE_F_MORE) != 0;
+        const bool       hasBlock = (c.flags & IORING_CQE_F_BUFFER) != 0;
+        const unsigned   bid      = c.flags >> IORING_CQE_BUFFER_SHIFT;
+        Op&              op       = ops_[index];
+        assert(op.inUse && opData(index, op.generation) == c.userData);
+        CompletionHandler* handler = op.handler;
+        const OpKind       kind    = op.kind;
+        // 最后一个结果 : 先回收槽位 (handler 中可能重新提交)，
+        // holder 保留到回调返回之后
+        std::shared_ptr<void> holder;
+        if (!more) {
+            holder = std::move(op.holder);
+            releaseOp(index);
+        }
+        if (handler == nullptr) {
+            if (kind == kAccept && c.res >= 0) {
+                ::close(c.res);
+            }
+        }
+        else if (kind == kAccept) {
+            handler->handleAcceptComplete(c.res, more);
+        }
+        else if (kind == kRecv) {
+            handler->handleRecvComplete(
+                c.res, hasBlock ? recvBlock(bid) : nullptr, more,
+                (c.flags & IORING_CQE_F_SOCK_NONEMPTY) != 0);
+        }
+        else {
+            handler->handleSendComplete(c.res);
+        }
+        if (hasBlock) {
+            recycleBlock(bid);
+        }
+    }
+    completions_.clear();
+}
+
+void UringPoller::recycleBlock(unsigned bid) {
+    // 环即 io_uring_buf 数组，tail 与 bufs[0] 的保留字段重叠。旧版头文件的
+    // bufs 在 C++ 中因空结构体占位而偏移 8 字节，不能直接使用
+    struct io_uring_buf& buf = reinterpret_cast<struct io_uring_buf*>(
+        bufRing_)[bufTail_ & (kRecvBlocks - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(recvBlock(bid) + kRecvHeadroom);
+    buf.len  = static_cast<uint32_t>(kRecvBlockSize - kRecvHeadroom);
+    buf.bid  = static_cast<uint16_t>(bid);
+    ++bufTail_;
+    __atomic_store_n(&bufRing_->tail, bufTail_, __ATOMIC_RELEASE);
+}
+
+void UringPoller::drainOps() {
+    // 之前已收取、尚未分发的结果
+    for (const Completion& c : completions_) {
+        Op* op = findOp(c.userData);
+        if (op == nullptr) {
+            continue;
+        }
+        if (op->kind == kAccept && c.res >= 0) {
+            ::close(c.res);
+        }
+        if (!(c.flags & IORING_CQE_F_MORE)) {
+            releaseOp(static_cast<uint32_t>(c.userData));
+        }
+    }
+    completions_.clear();
+
+    size_t inFlight = 0;
+    for (size_t i = 0; i < ops_.size(); ++i) {
+        if (ops_[i].inUse) {
+            abandon(opData(static_cast<uint32_t>(i), ops_[i].generation));
+            ++inFlight;
+        }
+    }
+    // 取消通常立即完成，最多等待 1s
+    for (int round = 0; inFlight > 0 && round < 10; ++round) {
+        wait(Nanoseconds(100 * 1000 * 1000));
+        unsigned       head = *cqHead_;
+        const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & cqMask_];
+            Op* op = cqe.user_data == kIgnoreTag ? nullptr
+                                                 : findOp(cqe.user_data);
+            if (op == nullptr) {
+                continue;
+            }
+            if (op->kind == kAccept && cqe.res >= 0) {
+                ::close(cqe.res);
+            }
+            if (!(cqe.flags & IORING_CQE_F_MORE)) {
+                releaseOp(static_cast<uint32_t>(cqe.user_data));
+                --inFlight;
+            }
+        }
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    }
+    if (inFlight > 0) {
+        LOG_WARN << "UringPoller " << inFlight << " operations still in flight";
+    }
+}
@@ -0,0 +1,167 @@
+#ifndef LIBNET_URINGPOLLER_H
+#define LIBNET_URINGPOLLER_H
+
+#include "core/Poller.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+namespace libnet {
+
+// 基于 io_uring 的 Poller，直接使用系统调用，不依赖 liburing
+// 就绪通知 : 关注事件的变化只是向 SQ 追加 POLL_ADD / POLL_REMOVE，与下一次
+// 等待合并为一次 io_uring_enter 提交，不需要 epoll_ctl。水平触发的 channel
+// 使用单次 poll，处理完后在下一次等待前重新注册；边沿触发的 channel 使用
+// 多次触发的 poll (IORING_POLL_ADD_MULTI)
+// 完成模式 (内核 6.1 起) : 多次触发的 accept、读入 provided buffer ring 的
+// 多次触发的 recv 与 sendmsg，同样随下一次等待批量提交
+class UringPoller : public Poller
+{
+public:
+    static const unsigned kSqEntries   = 256;
+    static const unsigned kCqEntries   = 4096;
+    static const unsigned kRecvBlocks  = 32;  // 须为 2 的幂
+    static const uint16_t kBufferGroup = 0;
+
+    explicit UringPoller(EventLoop* loop);
+    ~UringPoller() override;
+
+    // 内核不支持所需特性时为 false，此时不可使用
+    bool ok() const { return ringFd_ >= 0; }
+
+    void poll(ChannelList& activeChannels,
+              Nanoseconds  timeout = Nanoseconds(-1)) override;
+    void updateChannel(Channel* channel) override;
+
+    const char* name() const override { return "io_uring"; }
+
+    bool completionMode() const override { return bufRing_ != nullptr; }
+    OpId acceptMultishot(int                          fd,
+                         CompletionHandler*           handler,
+                         const std::shared_ptr<void>& holder) override;
+    OpId recvMultishot(int                          fd,
+                       CompletionHandler*           handler,
+                       const std::shared_ptr<void>& holder) override;
+    OpId sendMsg(int                          fd,
+                 const struct msghdr*         msg,
+                 CompletionHandler*           handler,
+                 const std::shared_ptr<void>& holder) override;
+    void cancel(OpId id) override;
+    void abandon(OpId id) override;
+
+private:
+    // 以 fd 为下标，generation 用于丢弃已经取消或过期的完成事件
+    struct Entry
+    {
+        Channel* channel     = nullptr;
+        uint32_t generation  = 0;
+        uint32_t events      = 0;  // channel 关注的事件 (poll 掩码与 epoll 相同)
+        bool     armed       = false;
+        bool     multishot   = false;
+        uint64_t batch       = 0;  // 最近一次出现在 activeChannels 中的批次
+        uint32_t activeIndex = 0;  // 在本批 activeChannels 中的位置
+        uint32_t revents     = 0;
+    };
+
+    enum OpKind : uint8_t { kAccept, kRecv, kSend };
+
+    // 完成模式的一次操作，最后一个结果送达后槽位才回收
+    struct Op
+    {
+        CompletionHandler*    handler    = nullptr;  // abandon 后为空
+        std::shared_ptr<void> holder;
+        uint32_t              generation = 0;
+        OpKind                kind       = kAccept;
+        bool                  inUse      = false;
+        bool                  cancelled  = false;
+    };
+
+    // 本批中完成模式的结果，由 completionChannel_ 在分发阶段交给 handler
+    struct Completion
+    {
+        uint64_t userData;
+        int32_t  res;
+        uint32_t flags;
+    };
+
+    bool setup();
+    bool setupBufferRing();
+    void unmapRings();
+
+    io_uring_sqe* getSqe();
+    // 提交所有 SQE 并等待至少一个完成事件，timeout 为 0 时不等待
+    int wait(Nanoseconds timeout);
+
+    void arm(int fd, Entry& entry);
+    void disarm(int fd, Entry& entry);
+    void reapCompletions(ChannelList& activeChannels);
+
+    io_uring_sqe* prepareOp(int                          fd,
+                            OpKind                       kind,
+                            CompletionHandler*           handler,
+                            const std::shared_ptr<void>& holder);
+    Op*   findOp(OpId id);
+    void  releaseOp(uint32_t index);
+    void  dispatchCompletions();
+    // 析构前取消所有操作并等待它们结束，之后才能释放缓冲区与 holder
+    void  drainOps();
+    char* recvBlock(unsigned bid) const {
+        return recvBlocks_ + static_cast<size_t>(bid) * kRecvBlockSize;
+    }
+    void recycleBlock(unsigned bid);
+
+    // poll : generation << 32 | fd，完成模式的操作 : kOpTag | generation << 32 |
+    // 槽位下标；generation 只取 31 位，最高位用来区分两者
+    static const uint64_t kOpTag     = 1ULL << 63;
+    static const uint64_t kIgnoreTag = ~0ULL;  // POLL_REMOVE 与取消自身的结果
+
+    static uint64_t userData(int fd, uint32_t generation) {
+        return static_cast<uint64_t>(generation & 0x7fffffff) << 32 |
+               static_cast<uint32_t>(fd);
+    }
+    static uint64_t opData(uint32_t index, uint32_t generation) {
+        return kOpTag | static_cast<uint64_t>(generation & 0x7fffffff) << 32 |
+               index;
+    }
+
+    int ringFd_;
+
+    void*    ring_;  // SQ 与 CQ 共用一次映射 (IORING_FEAT_SINGLE_MMAP)
+    size_t   ringSize_;
+    size_t   sqesSize_;
+    unsigned sqMask_;
+    unsigned sqEntries_;
+    unsigned cqMask_;
+
+    unsigned*     sqHead_;
+    unsigned*     sqTail_;
+    unsigned*     sqArray_;
+    unsigned*     cqHead_;
+    unsigned*     cqTail_;
+    io_uring_sqe* sqes_;
+    io_uring_cqe* cqes_;
+
+    std::vector<Entry> entries_;
+    std::vector<int>   rearm_;   // 单次 poll 已触发、需要重新注册的 fd
+    ChannelList*       active_;  // 正在分发的 activeChannels
+    uint64_t           batch_;
+
+    std::vector<Op>         ops_;
+    std::vector<uint32_t>   freeOps_;
+    std::vector<Completion> completions_;
+    // 不注册到内核，有结果时放入 activeChannels，借 loop 的分发阶段交给 handler
+    std::unique_ptr<Channel> completionChannel_;
+
+    io_uring_buf_ring* bufRing_;  // 为空时不支持完成模式
+    char*              recvBlocks_;
+    uint16_t           bufTail_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_URINGPOLLER_H
@@ -0,0 +1,111 @@
+#include "core/ZeroCopyGraveyard.h"
+#include "core/EventLoop.h"
+#include "logger/Logger.h"
+
+#include <cerrno>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace libnet;
+
+void libnet::readZeroCopyCompletions(
+    int fd, const std::function<void(uint32_t hi, bool copied)>& callback) {
+    char control[128];
+    for (;;) {
+        struct msghdr msg = {};
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+        if (::recvmsg(fd, &msg, MSG_ERRQUEUE) == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_SYSERR << "readZeroCopyCompletions() fd=" << fd;
+            }
+            break;
+        }
+        for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr;
+             cm = CMSG_NXTHDR(&msg, cm)) {
+            if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+                !(cm->cmsg_level == SOL_IPV6 &&
+                  cm->cmsg_type == IPV6_RECVERR)) {
+                continue;
+            }
+            const struct sock_extended_err* ee =
+                reinterpret_cast<const struct sock_extended_err*>(
+                    CMSG_DATA(cm));
+            if (ee->ee_errno != 0 || ee->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+            // [ee_info, ee_data] 区间内的发送已完成
+            callback(ee->ee_data,
+                     (ee->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0);
+        }
+    }
+}
+
+ZeroCopyGraveyard::ZeroCopyGraveyard(EventLoop* loop)
+    : loop_(loop), timer_(), graves_() {}
+
+ZeroCopyGraveyard::~ZeroCopyGraveyard() {
+    for (Grave& grave : graves_) {
+        abort(grave);
+    }
+}
+
+void ZeroCopyGraveyard::adopt(int fd, BufferChain::PinnedQueue&& pinned) {
+    loop_->assertInLoopThread();
+    Grave grave{ fd, loop_->pollReturnTime() + kMaxLinger.count(),
+                 std::move(pinned) };
+    if (drain(grave)) {
+        return;
+    }
+    graves_.push_back(std::move(grave));
+    if (graves_.size() == 1) {
+        timer_ = loop_->runEvery(kPollInterval, [this] { onTick(); });
+    }
+}
+
+bool ZeroCopyGraveyard::drain(Grave& grave) {
+    readZeroCopyCompletions(grave.fd, [&grave](uint32_t hi, bool) {
+        BufferChain::releasePinned(grave.pinned, hi);
+    });
+    if (!grave.pinned.empty()) {
+        return false;
+    }
+    ::close(grave.fd);
+    return true;
+}
+
+void ZeroCopyGraveyard::abort(Grave& grave) {
+    LOG_WARN << "ZeroCopyGraveyard abort fd=" << grave.fd << " with "
+             << grave.pinned.size() << " zerocopy sends in flight";
+    // SO_LINGER 0 : close 发出 RST 并丢弃发送队列，之后不再读取这些内存
+    struct linger lg = { 1, 0 };
+    ::setsockopt(grave.fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+    ::close(grave.fd);
+    grave.pinned.clear();
+}
+
+void ZeroCopyGraveyard::onTick() {
+    const int64_t now = loop_->pollReturnTime();
+    size_t        kept = 0;
+    for (Grave& grave : graves_) {
+        if (drain(grave)) {
+            continue;
+        }
+        if (now >= grave.deadline) {
+            abort(grave);
+            continue;
+        }
+        if (&graves_[kept] != &grave) {
+            graves_[kept] = std::move(grave);
+        }
+        ++kept;
+    }
+    graves_.erase(graves_.begin() + static_cast<ptrdiff_t>(kept),
+                  graves_.end());
+    if (graves_.empty()) {
+        loop_->cancelTimer(timer_);
+        timer_ = TimerId();
+    }
+}
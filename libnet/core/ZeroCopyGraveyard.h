@@ -0,0 +1,63 @@
+#ifndef LIBNET_ZEROCOPYGRAVEYARD_H
+#define LIBNET_ZEROCOPYGRAVEYARD_H
+
+#include "core/BufferChain.h"
+#include "core/TimerId.h"
+#include "core/Timestamp.h"
+#include "utils/noncopyable.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace libnet {
+
+class EventLoop;
+
+// 读出 fd 错误队列中的全部零拷贝完成通知
+// 每个通知回调一次 : 序号不超过 hi 的发送已完成，copied 表示内核退回了拷贝
+void readZeroCopyCompletions(
+    int fd, const std::function<void(uint32_t hi, bool copied)>& callback);
+
+// 每个 loop 一个，收留关闭时仍有零拷贝数据在途的连接
+// MSG_ZEROCOPY 发送的数据在对端确认前仍由内核直接从用户内存读取 (重传时也是)，
+// 提前释放 holder 会让内存被复用，发出的内容随之被改写。这里接管连接的 fd 与
+// 未完成的 holder，定期读取完成通知，全部完成后才关闭 fd。
+// 超过 kMaxLinger 仍未完成时以 RST 关闭，内核丢弃未发出的数据后再释放 holder。
+// 有条目时才以 runEvery 驱动。只能在 loop 线程中使用
+class ZeroCopyGraveyard : noncopyable
+{
+public:
+    static constexpr Nanoseconds kPollInterval = 20ms;
+    static constexpr Nanoseconds kMaxLinger    = 30s;
+
+    explicit ZeroCopyGraveyard(EventLoop* loop);
+    // 剩余的连接全部以 RST 关闭
+    ~ZeroCopyGraveyard();
+
+    // 接管 fd (负责关闭) 及其在途的零拷贝数据
+    void adopt(int fd, BufferChain::PinnedQueue&& pinned);
+
+    size_t size() const { return graves_.size(); }
+
+private:
+    struct Grave
+    {
+        int                      fd;
+        int64_t                  deadline;  // steady_clock 纳秒
+        BufferChain::PinnedQueue pinned;
+    };
+
+    // 读取完成通知，返回是否已全部完成
+    static bool drain(Grave& grave);
+    static void abort(Grave& grave);
+    void        onTick();
+
+    EventLoop*         loop_;
+    TimerId            timer_;
+    std::vector<Grave> graves_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_ZEROCOPYGRAVEYARD_H
@@ -0,0 +1,113 @@
+#ifndef LIBNET_BASE_HISTOGRAM_H
+#define LIBNET_BASE_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "utils/noncopyable.h"
+
+namespace libnet {
+
+// 对数-线性直方图 (HdrHistogram 的简化版)
+// 每个 2 的幂区间再均分为 kSubBuckets 个桶，相对误差不超过 1/kSubBuckets，
+// 固定 488 个桶即可覆盖全部非负 int64_t。
+// 只能由一个线程写入 (record 不使用原子读改写指令)，任意线程可随时无锁读取，
+// 读到的是近似一致的快照
+class Histogram : noncopyable
+{
+public:
+    static const int    kSubBits    = 3;
+    static const int    kSubBuckets = 1 << kSubBits;
+    static const size_t kNumBuckets = (64 - kSubBits) * kSubBuckets;
+
+    Histogram() : count_(0), sum_(0), max_(0) {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void record(int64_t value) {
+        if (value < 0) {
+            value = 0;
+        }
+        increment(buckets_[bucketIndex(value)]);
+        increment(count_);
+        sum_.store(sum_.load(std::memory_order_relaxed) + value,
+                   std::memory_order_relaxed);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    int64_t  sum() const { return sum_.load(std::memory_order_relaxed); }
+    int64_t  max() const { return max_.load(std::memory_order_relaxed); }
+    int64_t  mean() const {
+        const uint64_t n = count();
+        return n == 0 ? 0 : sum() / static_cast<int64_t>(n);
+    }
+
+    // q 取 [0, 1]，返回所在桶的上界
+    int64_t percentile(double q) const {
+        uint64_t total = 0;
+        for (const auto& bucket : buckets_) {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        if (total == 0) {
+            return 0;
+        }
+        const uint64_t rank = q <= 0 ? 1
+                              : q >= 1
+                                  ? total
+                                  : static_cast<uint64_t>(q * total + 0.5);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kNumBuckets; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank && seen > 0) {
+                const int64_t upper = bucketUpper(i);
+                const int64_t m     = max();
+                return upper < m ? upper : m;
+            }
+        }
+        return max();
+    }
+
+    static size_t bucketIndex(int64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        const int exp = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+        const int sub =
+            static_cast<int>(value >> (exp - kSubBits)) & (kSubBuckets - 1);
+        return static_cast<size_t>((exp - kSubBits + 1) * kSubBuckets + sub);
+    }
+
+    static int64_t bucketUpper(size_t index) {
+        if (index < static_cast<size_t>(kSubBuckets)) {
+            return static_cast<int64_t>(index);
+        }
+        const int exp = static_cast<int>(index / kSubBuckets) + kSubBits - 1;
+        const int sub = static_cast<int>(index % kSubBuckets);
+        const uint64_t lower = static_cast<uint64_t>(kSubBuckets + sub)
+                               << (exp - kSubBits);
+        return static_cast<int64_t>(lower +
+                                    (uint64_t(1) << (exp - kSubBits)) - 1);
+    }
+
+private:
+    template <typename T>
+    static void increment(std::atomic<T>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> buckets_[kNumBuckets];
+    std::atomic<uint64_t> count_;
+    std::atomic<int64_t>  sum_;
+    std::atomic<int64_t>  max_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_BASE_HISTOGRAM_H
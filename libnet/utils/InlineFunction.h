@@ -0,0 +1,182 @@
+#ifndef LIBNET_BASE_INLINEFUNCTION_H
+#define LIBNET_BASE_INLINEFUNCTION_H
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace libnet {
+
+template <typename Signature, size_t Capacity = 64>
+class InlineFunction;
+
+// 只可移动的 std::function 替代品
+// 不超过 Capacity 字节、可 noexcept 移动的可调用对象直接存放在对象内部，
+// 构造与移动都不分配内存；更大的对象才退回堆上分配
+// libstdc++ 的 std::function 只能内联存放 16 字节且可平凡复制的对象，
+// 捕获 shared_ptr 的 lambda 每次都要分配
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity>
+{
+public:
+    InlineFunction() noexcept : ops_(nullptr) {}
+    InlineFunction(std::nullptr_t) noexcept : ops_(nullptr) {}
+
+    template <typename F,
+              typename D = std::decay_t<F>,
+              typename   = std::enable_if_t<
+                  !std::is_same<D, InlineFunction>::value &&
+                  std::is_invocable_r<R, D&, Args...>::value>>
+    InlineFunction(F&& f) : ops_(nullptr) {
+        if constexpr (std::is_pointer<D>::value ||
+                      std::is_member_pointer<D>::value) {
+            if (f == nullptr) {
+                return;
+            }
+        }
+        if constexpr (kStoredInline<D>) {
+            ::new (storage_) D(std::forward<F>(f));
+        }
+        else {
+            *reinterpret_cast<D**>(storage_) = new D(std::forward<F>(f));
+        }
+        ops_ = &kOps<D>;
+    }
+
+    InlineFunction(InlineFunction&& rhs) noexcept : ops_(nullptr) {
+        moveFrom(rhs);
+    }
+
+    InlineFunction& operator=(InlineFunction&& rhs) noexcept {
+        if (this != &rhs) {
+            reset();
+            moveFrom(rhs);
+        }
+        return *this;
+    }
+
+    InlineFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    template <typename F,
+              typename = std::enable_if_t<
+                  !std::is_same<std::decay_t<F>, InlineFunction>::value>>
+    InlineFunction& operator=(F&& f) {
+        return *this = InlineFunction(std::forward<F>(f));
+    }
+
+    InlineFunction(const InlineFunction&)            = delete;
+    InlineFunction& operator=(const InlineFunction&) = delete;
+
+    ~InlineFunction() { reset(); }
+
+    // 与 std::function 一样，const 对象上调用的也是非 const 的可调用对象
+    R operator()(Args... args) const {
+        return ops_->invoke(storage_, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    void reset() noexcept {
+        if (ops_ != nullptr) {
+            if (ops_->destroy != nullptr) {
+                ops_->destroy(storage_);
+            }
+            ops_ = nullptr;
+        }
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    struct Ops
+    {
+        R (*invoke)(void* storage, Args&&... args);
+        // 把 src 中的对象移动到未初始化的 dst，并析构 src 中的对象；
+        // 为空时直接复制存储区 (可平凡复制的对象，或只存了堆上的指针)
+        void (*move)(void* dst, void* src) noexcept;
+        // 为空时不需要析构
+        void (*destroy)(void* storage) noexcept;
+        size_t size;  // 存储区中实际使用的字节数
+    };
+
+    void moveFrom(InlineFunction& rhs) noexcept {
+        if (rhs.ops_ == nullptr) {
+            return;
+        }
+        if (rhs.ops_->move != nullptr) {
+            rhs.ops_->move(storage_, rhs.storage_);
+        }
+        else {
+            ::memcpy(storage_, rhs.storage_, rhs.ops_->size);
+        }
+        ops_     = rhs.ops_;
+        rhs.ops_ = nullptr;
+    }
+
+    template <typename D>
+    static constexpr bool kStoredInline =
+        sizeof(D) <= Capacity &&
+        alignof(std::max_align_t) % alignof(D) == 0 &&
+        std::is_nothrow_move_constructible<D>::value;
+
+    template <typename D>
+    static D* target(void* storage) {
+        if constexpr (kStoredInline<D>) {
+            return std::launder(reinterpret_cast<D*>(storage));
+        }
+        else {
+            return *reinterpret_cast<D**>(storage);
+        }
+    }
+
+    template <typename D>
+    static R invoke(void* storage, Args&&... args) {
+        return std::invoke(*target<D>(storage), std::forward<Args>(args)...);
+    }
+
+    template <typename D>
+    static void move(void* dst, void* src) noexcept {
+        D* from = target<D>(src);
+        ::new (dst) D(std::move(*from));
+        from->~D();
+    }
+
+    template <typename D>
+    static void destroy(void* storage) noexcept {
+        if constexpr (kStoredInline<D>) {
+            target<D>(storage)->~D();
+        }
+        else {
+            delete target<D>(storage);
+        }
+    }
+
+    template <typename D>
+    static constexpr bool kTrivialMove =
+        !kStoredInline<D> || std::is_trivially_copyable<D>::value;
+
+    template <typename D>
+    static constexpr Ops kOps = {
+        &invoke<D>, kTrivialMove<D> ? nullptr : &move<D>,
+        kStoredInline<D> && std::is_trivially_destructible<D>::value
+            ? nullptr
+            : &destroy<D>,
+        kStoredInline<D> ? sizeof(D) : sizeof(D*)
+    };
+
+    static_assert(Capacity >= sizeof(void*),
+                  "InlineFunction capacity must hold a pointer");
+
+    const Ops*                                       ops_;
+    alignas(std::max_align_t) mutable unsigned char storage_[Capacity];
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_BASE_INLINEFUNCTION_H
@@ -0,0 +1,155 @@
+#ifndef LIBNET_BASE_MPSCQUEUE_H
+#define LIBNET_BASE_MPSCQUEUE_H
+
+#include "utils/noncopyable.h"
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace libnet {
+
+// 无锁多生产者单消费者队列 (Vyukov)
+// push 可在任意线程调用，只需一次 exchange；pop 只能由唯一的消费者线程调用
+// 生产者 push 到一半时 pop 可能暂时看不到之后的元素，调用方需自行保证
+// 之后还会再消费一次 (例如 push 之后再调度一次消费)
+// 消费过的节点放回最多 CachedNodes 个的缓存供 push 复用，稳定状态下
+// push/pop 不分配内存
+template <typename T, size_t CachedNodes = 64>
+class MpscQueue : noncopyable
+{
+public:
+    MpscQueue()
+        : head_(new Node),
+          tail_(head_.load(std::memory_order_relaxed)),
+          cachePushPos_(0),
+          cachePopPos_(0) {
+        for (size_t i = 0; i < CachedNodes; ++i) {
+            cache_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpscQueue() {
+        T value;
+        while (pop(value)) {
+        }
+        delete tail_;
+        while (Node* node = takeCached()) {
+            delete node;
+        }
+    }
+
+    void push(T&& value) {
+        Node* node = takeCached();
+        if (node == nullptr) {
+            node = new Node(std::move(value));
+        }
+        else {
+            node->value = std::move(value);
+            node->next.store(nullptr, std::memory_order_relaxed);
+        }
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    void push(const T& value) { push(T(value)); }
+
+    bool pop(T& value) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        value = std::move(next->value);
+        tail_ = next;
+        if (!cacheNode(tail)) {
+            delete tail;
+        }
+        return true;
+    }
+
+    // 依次取出调用时已经在队列中的元素交给 f，f 中再 push 的留给下一次
+    // f 返回 false 时提前停止，余下的元素留在队列中
+    template <typename F>
+    void consume(F&& f) {
+        Node* const last = head_.load(std::memory_order_acquire);
+        T           value;
+        while (tail_ != last && pop(value)) {
+            if (!f(value)) {
+                break;
+            }
+        }
+    }
+
+    // 只在消费者线程中有意义
+    bool empty() const {
+        return tail_->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node
+    {
+        Node() : next(nullptr) {}
+        explicit Node(T&& v) : next(nullptr), value(std::move(v)) {}
+
+        std::atomic<Node*> next;
+        T                  value;
+    };
+
+    static_assert(CachedNodes >= 2 && (CachedNodes & (CachedNodes - 1)) == 0,
+                  "CachedNodes must be a power of 2");
+
+    // 节点缓存是一个有界环形队列 (Vyukov)，每个槽位的 seq 标明它当前可放入
+    // 还是可取出：放入只由消费者进行，取出可能来自多个生产者
+    struct Cell
+    {
+        std::atomic<size_t> seq;
+        Node*               node;
+    };
+
+    bool cacheNode(Node* node) {
+        const size_t pos  = cachePushPos_;
+        Cell&        cell = cache_[pos & (CachedNodes - 1)];
+        if (cell.seq.load(std::memory_order_acquire) != pos) {
+            return false;  // 缓存已满
+        }
+        cell.node     = node;
+        cachePushPos_ = pos + 1;
+        cell.seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    Node* takeCached() {
+        size_t pos = cachePopPos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell&        cell = cache_[pos & (CachedNodes - 1)];
+            const size_t seq  = cell.seq.load(std::memory_order_acquire);
+            const auto   diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (cachePopPos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    Node* node = cell.node;
+                    cell.seq.store(pos + CachedNodes, std::memory_order_release);
+                    return node;
+                }
+            }
+            else if (diff < 0) {
+                return nullptr;  // 缓存为空
+            }
+            else {
+                pos = cachePopPos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::atomic<Node*> head_;  // 生产者端
+    Node*              tail_;  // 消费者端，始终指向一个已消费的哨兵节点
+
+    Cell                cache_[CachedNodes];
+    size_t              cachePushPos_;  // 只由消费者修改
+    std::atomic<size_t> cachePopPos_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_BASE_MPSCQUEUE_H
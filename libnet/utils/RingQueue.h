@@ -0,0 +1,126 @@
+#ifndef LIBNET_BASE_RINGQUEUE_H
+#define LIBNET_BASE_RINGQUEUE_H
+
+#include "utils/noncopyable.h"
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace libnet {
+
+// 双端环形队列，接口与 std::deque 的一个子集相同
+// 两端的 push/pop 复用已有的槽位，容量不足时翻倍，从不收缩，
+// 稳定状态下不分配内存 (std::deque 的元素跨过内部分段时会申请、释放分段)
+// 扩容时元素被移动，之前取得的引用失效
+template <typename T>
+class RingQueue : noncopyable
+{
+public:
+    class const_iterator
+    {
+    public:
+        const_iterator(const RingQueue* queue, size_t index)
+            : queue_(queue), index_(index) {}
+
+        const T&        operator*() const { return (*queue_)[index_]; }
+        const T*        operator->() const { return &(*queue_)[index_]; }
+        const_iterator& operator++() {
+            ++index_;
+            return *this;
+        }
+        bool operator!=(const const_iterator& rhs) const {
+            return index_ != rhs.index_;
+        }
+        bool operator==(const const_iterator& rhs) const {
+            return index_ == rhs.index_;
+        }
+
+    private:
+        const RingQueue* queue_;
+        size_t           index_;
+    };
+
+    RingQueue() : slots_(nullptr), capacity_(0), head_(0), size_(0) {}
+
+    ~RingQueue() {
+        clear();
+        ::operator delete(slots_);
+    }
+
+    bool   empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+
+    T& operator[](size_t index) {
+        assert(index < size_);
+        return slots_[(head_ + index) & (capacity_ - 1)];
+    }
+    const T& operator[](size_t index) const {
+        assert(index < size_);
+        return slots_[(head_ + index) & (capacity_ - 1)];
+    }
+
+    T&       front() { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T&       back() { return (*this)[size_ - 1]; }
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size_); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            grow();
+        }
+        T* slot = &slots_[(head_ + size_) & (capacity_ - 1)];
+        new (slot) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void pop_front() {
+        front().~T();
+        head_ = (head_ + 1) & (capacity_ - 1);
+        --size_;
+    }
+
+    void pop_back() {
+        back().~T();
+        --size_;
+    }
+
+    void clear() {
+        while (!empty()) {
+            pop_back();
+        }
+    }
+
+private:
+    static const size_t kInitialCapacity = 8;  // 须为 2 的幂
+
+    void grow() {
+        const size_t capacity = capacity_ == 0 ? kInitialCapacity : capacity_ * 2;
+        T* slots = static_cast<T*>(::operator new(capacity * sizeof(T)));
+        for (size_t i = 0; i < size_; ++i) {
+            T& item = (*this)[i];
+            new (&slots[i]) T(std::move(item));
+            item.~T();
+        }
+        ::operator delete(slots_);
+        slots_    = slots;
+        capacity_ = capacity;
+        head_     = 0;
+    }
+
+    T*     slots_;
+    size_t capacity_;
+    size_t head_;
+    size_t size_;
+};
+
+}  // namespace libnet
+
+#endif  // LIBNET_BASE_RINGQUEUE_H
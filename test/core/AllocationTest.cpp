@@ -0,0 +1,193 @@
+#include "core/EventLoop.h"
+#include "core/TcpConnection.h"
+#include "core/TcpServer.h"
+#include "logger/Logger.h"
+
+#include <catch2/catch.hpp>
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <netinet/in.h>
+#include <new>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace libnet;
+
+namespace {
+
+// 所有线程的堆分配次数
+std::atomic<size_t> gAllocations(0);
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// 在客户端线程中调用，失败时返回 -1 (Catch2 的断言只能在测试线程中使用)
+int connectLoopback(uint16_t port) {
+    struct sockaddr_in addr = {};
+    addr.sin_family         = AF_INET;
+    addr.sin_port           = htons(port);
+    addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 &&
+        ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+bool readAll(int fd, size_t len) {
+    char buf[65536];
+    while (len > 0) {
+        const ssize_t n = ::read(fd, buf, std::min(len, sizeof buf));
+        if (n <= 0) {
+            return false;
+        }
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+// 稳定状态下 (队列节点、输出缓冲已经预热)，其他线程的 TcpConnection::send
+// (共享 payload 与能放进 std::string 内部缓冲的小消息) 与 queueInLoop
+// 在发送线程和 loop 线程中都不应再分配内存
+TEST_CASE("Cross-thread send and queueInLoop do not allocate",
+          "[Allocation]") {
+    Logger::setLogLevel(Logger::ERROR);
+    const uint16_t port       = 19804;
+    const int      kBurst     = 6;  // 每批 12 条消息，不超过连接发送队列缓存的节点数
+    const int      kWarmup    = 4;
+    const int      kRounds    = 100;
+    const char     kSmall[]   = "0123456789";
+    const size_t   kSmallSize = sizeof kSmall - 1;
+
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(port), false, 0s);
+    server.setNumThreads(1);
+
+    std::mutex       mutex;
+    TcpConnectionPtr conn;
+    server.setConnectionCallback([&](const TcpConnectionPtr& c) {
+        if (c->connected()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            conn = c;
+        }
+    });
+    server.start();
+
+    bool   ok              = true;
+    size_t sendAllocations = 0;
+    size_t taskAllocations = 0;
+    std::thread client([&] {
+        const int fd = connectLoopback(port);
+        ok &= fd >= 0;
+        TcpConnectionPtr target;
+        while (ok && !target) {
+            std::lock_guard<std::mutex> lock(mutex);
+            target = conn;
+        }
+        const auto   payload = std::make_shared<const std::string>(4096, 'p');
+        const size_t burstBytes = kBurst * (payload->size() + kSmallSize);
+        const auto   sendBurst  = [&] {
+            for (int i = 0; i < kBurst; ++i) {
+                target->send(payload);
+                target->send(kSmall, kSmallSize);
+            }
+        };
+
+        std::atomic<int> executed(0);
+        EventLoop* const ioLoop = ok ? target->getLoop() : nullptr;
+        const auto postBurst = [&] {
+            for (int i = 0; i < kBurst; ++i) {
+                ioLoop->queueInLoop([target, &executed] {
+                    if (target->connected()) {
+                        ++executed;
+                    }
+                });
+            }
+        };
+        const auto waitExecuted = [&executed](int expected) {
+            while (executed.load() < expected) {
+                std::this_thread::yield();
+            }
+        };
+
+        if (ok) {
+            // 预热 : 先让 loop 停住，整批消息与 task 同时积压在队列中，
+            // 队列节点、输出链的槽位都增长到一批所需的数量
+            for (int i = 0; i < kWarmup; ++i) {
+                std::atomic<bool> stalled(false);
+                std::atomic<bool> released(false);
+                ioLoop->queueInLoop([&stalled, &released] {
+                    stalled = true;
+                    while (!released) {
+                        std::this_thread::yield();
+                    }
+                });
+                while (!stalled) {
+                    std::this_thread::yield();
+                }
+                const int expected = executed.load() + kBurst;
+                sendBurst();
+                postBurst();
+                released = true;
+                ok &= readAll(fd, burstBytes);
+                waitExecuted(expected);
+            }
+            size_t before = gAllocations.load();
+            for (int i = 0; i < kRounds && ok; ++i) {
+                sendBurst();
+                ok &= readAll(fd, burstBytes);
+            }
+            sendAllocations = gAllocations.load() - before;
+            before          = gAllocations.load();
+            for (int i = 0; i < kRounds; ++i) {
+                const int expected = executed.load() + kBurst;
+                postBurst();
+                waitExecuted(expected);
+            }
+            taskAllocations = gAllocations.load() - before;
+        }
+
+        target.reset();
+        ::close(fd);
+        while (true) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!conn || conn->disconnected()) {
+                break;
+            }
+        }
+        loop.runAfter(50ms, [&loop] { loop.quit(); });
+    });
+    loop.loop();
+    client.join();
+    conn.reset();
+
+    REQUIRE(ok);
+    REQUIRE(sendAllocations == 0);
+    REQUIRE(taskAllocations == 0);
+}
@@ -0,0 +1,174 @@
+#include "core/BufferChain.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace libnet;
+
+namespace {
+
+// 非阻塞的 unix socket 对，writeFd 写 fds[0]，从 fds[1] 读回
+struct SocketPair
+{
+    SocketPair() {
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+    }
+    ~SocketPair() {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+
+    std::string readAll() {
+        std::string result;
+        char        buf[4096];
+        ssize_t     n;
+        while ((n = ::read(fds[1], buf, sizeof buf)) > 0) {
+            result.append(buf, static_cast<size_t>(n));
+        }
+        return result;
+    }
+
+    int fds[2];
+};
+
+// 写入内容后即删除的临时文件
+struct TempFile
+{
+    explicit TempFile(const std::string& content) {
+        char path[] = "/tmp/libnet_chain_XXXXXX";
+        fd          = ::mkstemp(path);
+        REQUIRE(fd >= 0);
+        ::unlink(path);
+        REQUIRE(::write(fd, content.data(), content.size()) ==
+                static_cast<ssize_t>(content.size()));
+    }
+    ~TempFile() { ::close(fd); }
+
+    int fd;
+};
+
+std::string pattern(size_t len, char seed) {
+    std::string s(len, '\0');
+    for (size_t i = 0; i < len; ++i) {
+        s[i] = static_cast<char>(seed + i % 23);
+    }
+    return s;
+}
+
+}  // namespace
+
+TEST_CASE("BufferChain append and retrieve across blocks", "[BufferChain]") {
+    BufferChain chain;
+    const std::string data = pattern(3 * BufferChain::kBlockSize + 100, 'a');
+    chain.append(data);
+    REQUIRE(chain.readableBytes() == data.size());
+    REQUIRE(chain.numBlocks() == 4);
+
+    REQUIRE(chain.retrieveAsString(10) == data.substr(0, 10));
+    REQUIRE(chain.retrieveAllAsString() == data.substr(10));
+    REQUIRE(chain.empty());
+    // 保留一个 block 供复用
+    REQUIRE(chain.numBlocks() == 1);
+    chain.releaseIfEmpty();
+    REQUIRE(chain.numBlocks() == 0);
+}
+
+TEST_CASE("BufferChain keeps references without copying", "[BufferChain]") {
+    BufferChain chain;
+    auto payload = std::make_shared<const std::string>(pattern(4096, 'p'));
+    chain.append("head", 4);
+    chain.append(payload);
+    chain.append("tail", 4);
+    REQUIRE(chain.numBlocks() == 3);
+    REQUIRE(payload.use_count() == 2);
+
+    REQUIRE(chain.retrieveAllAsString() == "head" + *payload + "tail");
+    REQUIRE(payload.use_count() == 1);
+}
+
+TEST_CASE("BufferChain writeFd past a drained block", "[BufferChain]") {
+    SocketPair  sp;
+    BufferChain chain;
+    int         savedErrno = 0;
+
+    chain.append("hello", 5);
+    REQUIRE(chain.writeFd(sp.fds[0], &savedErrno) == 5);
+    REQUIRE(chain.empty());
+    REQUIRE(sp.readAll() == "hello");
+
+    SECTION("file block") {
+        const std::string content = pattern(10000, 'f');
+        TempFile          file(content);
+        chain.appendFile(file.fd, 0, content.size(), nullptr);
+        REQUIRE(chain.writeFd(sp.fds[0], &savedErrno) ==
+                static_cast<ssize_t>(content.size()));
+        REQUIRE(sp.readAll() == content);
+    }
+
+    SECTION("zero-copy block") {
+        auto payload = std::make_shared<const std::string>(pattern(8192, 'z'));
+        chain.setZeroCopyThreshold(4096);
+        chain.append(payload);
+        REQUIRE(chain.writeFd(sp.fds[0], &savedErrno) ==
+                static_cast<ssize_t>(payload->size()));
+        REQUIRE(sp.readAll() == *payload);
+    }
+
+    REQUIRE(chain.empty());
+}
+
+TEST_CASE("BufferChain writeFd keeps order of mixed blocks", "[BufferChain]") {
+    SocketPair  sp;
+    BufferChain chain;
+    int         savedErrno = 0;
+
+    const std::string content = pattern(20000, 'f');
+    TempFile          file(content);
+    auto payload = std::make_shared<const std::string>(pattern(6000, 'z'));
+    chain.setZeroCopyThreshold(4096);
+
+    std::string expected;
+    chain.append("owned-", 6);
+    expected += "owned-";
+    chain.appendFile(file.fd, 100, 5000, nullptr);
+    expected += content.substr(100, 5000);
+    chain.append(payload);
+    expected += *payload;
+    chain.append(std::string(pattern(1000, 'm')));
+    expected += pattern(1000, 'm');
+    chain.appendFile(file.fd, 0, 100, nullptr);
+    expected += content.substr(0, 100);
+
+    REQUIRE(chain.writeFd(sp.fds[0], &savedErrno) ==
+            static_cast<ssize_t>(expected.size()));
+    REQUIRE(chain.empty());
+    REQUIRE(sp.readAll() == expected);
+}
+
+TEST_CASE("BufferChain writeFd stops when the socket is full", "[BufferChain]") {
+    SocketPair  sp;
+    BufferChain chain;
+    int         savedErrno = 0;
+
+    const std::string content = pattern(4 * 1024 * 1024, 'f');
+    TempFile          file(content);
+    chain.append("x", 1);
+    chain.appendFile(file.fd, 0, content.size(), nullptr);
+
+    std::string received;
+    while (!chain.empty()) {
+        ssize_t n = chain.writeFd(sp.fds[0], &savedErrno);
+        if (n < 0) {
+            REQUIRE(savedErrno == EAGAIN);
+        }
+        received += sp.readAll();
+    }
+    received += sp.readAll();
+    REQUIRE(received == "x" + content);
+}
@@ -0,0 +1,66 @@
+#include "core/Channel.h"
+#include "core/EventLoop.h"
+#include "core/Poller.h"
+
+#include <catch2/catch.hpp>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace libnet;
+
+namespace {
+
+// fds[0] 一直可写，写入 fds[1] 的数据不读走，fds[0] 也一直可读
+struct SocketPair
+{
+    SocketPair() {
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                             0, fds) == 0);
+        REQUIRE(::write(fds[1], "x", 1) == 1);
+    }
+    ~SocketPair() {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+    int fds[2];
+};
+
+}  // namespace
+
+// 边沿触发时，同一轮中先关闭再打开写事件，最终的关注事件不变，
+// 但仍要 EPOLL_CTL_MOD 让内核重新检查 : 仍然可写应再次通知
+// (只关闭读事件会使关注事件为空，channel 被直接删除，不在此列)
+TEST_CASE("EPoller re-arms edge-triggered channels re-enabled in one round",
+          "[EPoller]") {
+    const bool edgeTriggered = GENERATE(true, false);
+    EventLoop  loop;
+    SocketPair pair;
+    Channel    channel(&loop, pair.fds[0]);
+    int        writes = 0;
+
+    channel.setEdgeTriggered(edgeTriggered);
+    channel.setReadCallback([] {});
+    channel.setWriteCallback([&] {
+        if (++writes == 1) {
+            channel.disableWriting();
+            channel.enableWriting();
+        }
+        else {
+            loop.quit();
+        }
+    });
+    channel.enableAll();
+    loop.runAfter(1s, [&] { loop.quit(); });
+
+    const Poller::Stats before = loop.poller()->stats();
+    loop.loop();
+    const Poller::Stats after = loop.poller()->stats();
+    channel.disableAll();
+
+    REQUIRE(writes == 2);
+    // 水平触发时抵消的修改不需要 epoll_ctl
+    if (!edgeTriggered) {
+        REQUIRE(after.ctlAvoided - before.ctlAvoided >= 2);
+    }
+}
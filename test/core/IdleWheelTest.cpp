@@ -0,0 +1,112 @@
+#include "core/IdleWheel.h"
+#include "core/EventLoop.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using namespace libnet;
+
+namespace {
+
+// 触发时刻允许的误差 : 最多推迟约一个 kTick，再加上调度的余量
+const int64_t kSlack = (IdleWheel::kTick + 100ms).count();
+
+}  // namespace
+
+TEST_CASE("IdleWheel fires idle entries after the timeout", "[IdleWheel]") {
+    EventLoop            loop;
+    IdleWheel&           wheel   = loop.idleWheel();
+    const Nanoseconds    timeout = 300ms;
+    int64_t              start   = 0;
+    std::vector<int64_t> fired;  // 相对 start 的触发时刻
+
+    IdleWheel::Entry entry([&] {
+        fired.push_back(loop.pollReturnTime() - start);
+        // 未移除时重新计时，再次空闲后再次回调
+        if (fired.size() == 2) {
+            wheel.remove(&entry);
+            loop.quit();
+        }
+    });
+    loop.queueInLoop([&] {
+        start = loop.pollReturnTime();
+        wheel.add(&entry, timeout);
+        REQUIRE(entry.linked());
+        REQUIRE(wheel.size() == 1);
+    });
+    loop.runAfter(3s, [&] { loop.quit(); });
+    loop.loop();
+
+    REQUIRE(fired.size() == 2);
+    REQUIRE(fired[0] >= timeout.count());
+    REQUIRE(fired[0] < timeout.count() + kSlack);
+    REQUIRE(fired[1] - fired[0] >= timeout.count());
+    REQUIRE(fired[1] - fired[0] < timeout.count() + kSlack);
+    REQUIRE_FALSE(entry.linked());
+    REQUIRE(wheel.size() == 0);
+}
+
+TEST_CASE("IdleWheel restarts the timeout on touch", "[IdleWheel]") {
+    EventLoop         loop;
+    IdleWheel&        wheel      = loop.idleWheel();
+    const Nanoseconds timeout    = 400ms;
+    int64_t           lastTouch  = 0;
+    int64_t           firedAfter = -1;  // 相对最后一次 touch
+
+    IdleWheel::Entry entry([&] {
+        firedAfter = loop.pollReturnTime() - lastTouch;
+        wheel.remove(&entry);
+        loop.quit();
+    });
+    loop.queueInLoop([&] {
+        lastTouch = loop.pollReturnTime();
+        wheel.add(&entry, timeout);
+    });
+    // 前 1.2s 内每 100ms 活动一次，之后保持空闲
+    TimerId toucher = loop.runEvery(100ms, [&] {
+        entry.touch();
+        lastTouch = loop.pollReturnTime();
+    });
+    loop.runAfter(1200ms, [&] {
+        loop.cancelTimer(toucher);
+        REQUIRE(firedAfter < 0);
+    });
+    loop.runAfter(4s, [&] { loop.quit(); });
+    loop.loop();
+
+    REQUIRE(firedAfter >= timeout.count());
+    REQUIRE(firedAfter < timeout.count() + kSlack);
+}
+
+TEST_CASE("IdleWheel entries can be removed before or during callbacks",
+          "[IdleWheel]") {
+    EventLoop  loop;
+    IdleWheel& wheel        = loop.idleWheel();
+    int        removedFired = 0;
+    int        otherFired   = 0;
+
+    IdleWheel::Entry removed([&] { ++removedFired; });
+    IdleWheel::Entry other([&] { ++otherFired; });
+    IdleWheel::Entry first([&] {
+        // 同一个桶中的其他条目在回调中被移除后不再回调
+        wheel.remove(&other);
+        wheel.remove(&first);
+    });
+    loop.queueInLoop([&] {
+        wheel.add(&first, 300ms);
+        wheel.add(&other, 300ms);
+        wheel.add(&removed, 300ms);
+        wheel.remove(&removed);
+        REQUIRE(wheel.size() == 2);
+    });
+    loop.runAfter(1s, [&] { loop.quit(); });
+    loop.loop();
+
+    REQUIRE(removedFired == 0);
+    REQUIRE(otherFired == 0);
+    REQUIRE(wheel.size() == 0);
+    // 没有条目时不再驱动定时器
+    REQUIRE(loop.numTimers() == 0);
+}
@@ -0,0 +1,186 @@
+#include "core/EventLoop.h"
+#include "core/TcpConnection.h"
+#include "core/TcpServer.h"
+#include "logger/Logger.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace libnet;
+
+namespace {
+
+// 在客户端线程中调用，失败时返回 -1 (Catch2 的断言只能在测试线程中使用)
+int connectLoopback(uint16_t port) {
+    struct sockaddr_in addr = {};
+    addr.sin_family         = AF_INET;
+    addr.sin_port           = htons(port);
+    addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 &&
+        ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+bool writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        const ssize_t n = ::write(fd, data, len);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 按偏移生成的数据，错位或被覆盖都能发现
+char patternAt(size_t offset) {
+    return static_cast<char>((offset * 7) ^ (offset >> 9));
+}
+
+std::string pattern(size_t begin, size_t len) {
+    std::string data(len, '\0');
+    for (size_t i = 0; i < len; ++i) {
+        data[i] = patternAt(begin + i);
+    }
+    return data;
+}
+
+void waitFor(const std::atomic<size_t>& value, size_t expected) {
+    while (value.load() < expected) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+}  // namespace
+
+// loop A 上的连接把输入 Buffer 转发给 loop B 上的连接 (代理)。
+// A 的输入 Buffer 可能借用 A 的 scratch，不能把它交给 B : B 的输出积压时，
+// A 上的其他连接随后读入 scratch 会覆盖尚未发出的数据
+TEST_CASE("TcpConnection forwards input buffers across loops",
+          "[TcpConnection]") {
+    Logger::setLogLevel(Logger::ERROR);
+    const uint16_t port       = 19801;
+    const size_t   fillSize   = 16 * 1024 * 1024;
+    const size_t   sourceSize = 48 * 1024;
+
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(port), false, 0s);
+    server.setNumThreads(2);  // 连接轮流分配到两个 I/O loop
+
+    // 依次建立 : sink 与 filler 在 loop B，source 与 noise 在 loop A
+    enum
+    {
+        kSink,
+        kSource,
+        kFiller,
+        kNoise,
+        kNumConns
+    };
+    std::mutex                    mutex;
+    std::vector<TcpConnectionPtr> conns;
+    std::atomic<size_t>           received[kNumConns] = {};
+    server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            conns.push_back(conn);
+        }
+    });
+    server.setMessageCallback([&](const TcpConnectionPtr& conn,
+                                  Buffer&                 buffer) {
+        TcpConnectionPtr sink;
+        size_t           index;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sink  = conns.front();
+            index = static_cast<size_t>(
+                std::find(conns.begin(), conns.end(), conn) - conns.begin());
+        }
+        const size_t len = buffer.readableBytes();
+        if (index == kSource || index == kFiller) {
+            sink->send(buffer);
+        }
+        buffer.retrieveAll();
+        received[index] += len;
+    });
+    server.start();
+
+    const auto numConns = [&mutex, &conns] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return conns.size();
+    };
+    std::string output;
+    bool        written = true;
+    std::thread client([&] {
+        int fds[kNumConns];
+        for (int i = 0; i < kNumConns; ++i) {
+            fds[i] = connectLoopback(port);
+            while (numConns() < static_cast<size_t>(i + 1)) {
+                std::this_thread::yield();
+            }
+        }
+        // sink 的客户端先不读 : filler 的数据 (同一 loop 内转发) 积压在
+        // sink 的输出队列中，之后 source 转发来的数据也只能留在队列里
+        const std::string fill = pattern(0, fillSize);
+        written &= writeAll(fds[kFiller], fill.data(), fill.size());
+        waitFor(received[kFiller], fillSize);
+        const std::string source = pattern(fillSize, sourceSize);
+        written &= writeAll(fds[kSource], source.data(), source.size());
+        waitFor(received[kSource], sourceSize);
+        // 与 source 同一 loop 的连接读入数据
+        const std::string noise(sourceSize, 'x');
+        written &= writeAll(fds[kNoise], noise.data(), noise.size());
+        waitFor(received[kNoise], sourceSize);
+
+        char buf[65536];
+        while (output.size() < fillSize + sourceSize) {
+            const ssize_t n = ::read(fds[kSink], buf, sizeof buf);
+            if (n <= 0) {
+                break;
+            }
+            output.append(buf, static_cast<size_t>(n));
+        }
+        for (int fd : fds) {
+            ::close(fd);
+        }
+        // 等连接关闭后再析构 server
+        for (bool closed = false; !closed;) {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = std::all_of(conns.begin(), conns.end(),
+                                 [](const TcpConnectionPtr& conn) {
+                                     return conn->disconnected();
+                                 });
+        }
+        loop.runAfter(50ms, [&loop] { loop.quit(); });
+    });
+    loop.loop();
+    client.join();
+
+    REQUIRE(written);
+    REQUIRE(conns.size() == kNumConns);
+    REQUIRE(conns[kSink]->getLoop() == conns[kFiller]->getLoop());
+    REQUIRE(conns[kSource]->getLoop() == conns[kNoise]->getLoop());
+    REQUIRE(conns[kSink]->getLoop() != conns[kSource]->getLoop());
+    conns.clear();
+
+    REQUIRE(output.size() == fillSize + sourceSize);
+    size_t mismatch = 0;
+    while (mismatch < output.size() && output[mismatch] == patternAt(mismatch)) {
+        ++mismatch;
+    }
+    REQUIRE(mismatch == output.size());
+}
@@ -0,0 +1,123 @@
+#include "core/EventLoop.h"
+#include "core/TcpConnection.h"
+#include "core/TcpServer.h"
+#include "logger/Logger.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <set>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace libnet;
+
+namespace {
+
+// 在客户端线程中调用，失败时返回 -1 (Catch2 的断言只能在测试线程中使用)
+int connectLoopback(uint16_t port) {
+    struct sockaddr_in addr = {};
+    addr.sin_family         = AF_INET;
+    addr.sin_port           = htons(port);
+    addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 &&
+        ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+}  // namespace
+
+// SO_REUSEPORT 模式下每个线程有自己的 TcpSubReactor，
+// 所有 I/O loop 上的连接超时后都应回调 idleTimeoutCallback 而不是被关闭
+TEST_CASE("TcpServer forwards the idle timeout callback to every loop",
+          "[TcpServer]") {
+    Logger::setLogLevel(Logger::ERROR);
+    const uint16_t    port    = 19802;
+    const Nanoseconds timeout = 300ms;
+
+    EventLoop loop;
+    TcpServer server(&loop, InetAddress(port), true, timeout);
+    server.setNumThreads(4);
+
+    std::mutex                              mutex;
+    std::vector<TcpConnectionPtr>           conns;
+    std::map<const TcpConnection*, int>     idleCalls;
+    server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            conns.push_back(conn);
+        }
+    });
+    server.setIdleTimeoutCallback([&](const TcpConnectionPtr& conn) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++idleCalls[conn.get()];
+    });
+    server.start();
+
+    const auto loopsUsed = [&mutex, &conns] {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::set<EventLoop*> loops;
+        for (const TcpConnectionPtr& conn : conns) {
+            loops.insert(conn->getLoop());
+        }
+        return loops.size();
+    };
+    std::vector<int>  fds;
+    std::atomic<bool> closedByServer(false);
+    std::thread       client([&] {
+        // 内核按四元组的哈希分配连接，建立连接直到用上至少 3 个 loop
+        while (fds.size() < 64 && (fds.size() < 8 || loopsUsed() < 3)) {
+            const int fd = connectLoopback(port);
+            if (fd < 0) {
+                break;
+            }
+            fds.push_back(fd);
+            while (loopsUsed() == 0 || [&] {
+                std::lock_guard<std::mutex> lock(mutex);
+                return conns.size() < fds.size();
+            }()) {
+                std::this_thread::yield();
+            }
+        }
+        // 超时至少两次，连接应一直保持
+        std::this_thread::sleep_for(3 * timeout + 300ms);
+        for (int fd : fds) {
+            char buf[1];
+            if (::recv(fd, buf, sizeof buf, MSG_DONTWAIT) >= 0 ||
+                errno != EAGAIN) {
+                closedByServer = true;
+            }
+            ::close(fd);
+        }
+        for (bool closed = false; !closed;) {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = std::all_of(conns.begin(), conns.end(),
+                                 [](const TcpConnectionPtr& conn) {
+                                     return conn->disconnected();
+                                 });
+        }
+        loop.runAfter(50ms, [&loop] { loop.quit(); });
+    });
+    loop.loop();
+    client.join();
+
+    REQUIRE(loopsUsed() >= 3);
+    REQUIRE_FALSE(closedByServer);
+    REQUIRE(conns.size() == fds.size());
+    for (const TcpConnectionPtr& conn : conns) {
+        REQUIRE(idleCalls[conn.get()] >= 2);
+    }
+    conns.clear();
+}
@@ -0,0 +1,80 @@
+#include "core/TimerPool.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace libnet;
+
+// 块表多次翻倍，之前的 TimerId 仍然可用
+TEST_CASE("TimerPool grows past its initial chunk table", "[TimerPool]") {
+    TimerPool            pool;
+    const size_t         count = 40 * TimerPool::kChunkSize;
+    std::vector<TimerId> ids;
+    for (size_t i = 0; i < count; ++i) {
+        ids.push_back(pool.allocate());
+        REQUIRE(ids.back().valid());
+    }
+    REQUIRE(pool.size() == count);
+    std::set<uint32_t> indexes;
+    for (const TimerId& id : ids) {
+        REQUIRE(pool.get(id) != nullptr);
+        indexes.insert(id.index());
+    }
+    REQUIRE(indexes.size() == count);
+
+    for (const TimerId& id : ids) {
+        pool.release(pool.get(id));
+        REQUIRE(pool.get(id) == nullptr);
+    }
+    REQUIRE(pool.size() == 0);
+}
+
+// 多个线程同时 allocate 触发扩容
+TEST_CASE("TimerPool allocates from many threads", "[TimerPool]") {
+    const int      kThreads   = 4;
+    const uint32_t kPerThread = 10 * TimerPool::kChunkSize;
+
+    TimerPool                         pool;
+    std::vector<std::vector<TimerId>> ids(kThreads);
+    std::vector<std::thread>          threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&pool, &ids, t] {
+            for (uint32_t i = 0; i < kPerThread; ++i) {
+                ids[t].push_back(pool.allocate());
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::set<uint32_t> indexes;
+    for (const auto& list : ids) {
+        for (const TimerId& id : list) {
+            REQUIRE(pool.get(id) != nullptr);
+            indexes.insert(id.index());
+        }
+    }
+    REQUIRE(indexes.size() == kThreads * kPerThread);
+}
+
+// 达到上限时 allocate 失败而不是终止进程，释放后又可以分配
+TEST_CASE("TimerPool fails allocation at its limit", "[TimerPool]") {
+    TimerPool            pool(2 * TimerPool::kChunkSize);
+    std::vector<TimerId> ids;
+    for (uint32_t i = 0; i < 2 * TimerPool::kChunkSize; ++i) {
+        ids.push_back(pool.allocate());
+        REQUIRE(ids.back().valid());
+    }
+    const TimerId failed = pool.allocate();
+    REQUIRE_FALSE(failed.valid());
+    REQUIRE(pool.get(failed) == nullptr);
+    REQUIRE(pool.size() == ids.size());
+
+    pool.release(pool.get(ids.front()));
+    REQUIRE(pool.allocate().valid());
+}
@@ -0,0 +1,153 @@
+#include "core/TimerHeap.h"
+#include "core/TimingWheel.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+
+using namespace libnet;
+
+namespace {
+
+// 同一个定时器分别放入两个容器 (Timer 只能属于一个 TimerStore)
+struct TimerPair
+{
+    std::unique_ptr<Timer> heap  = std::make_unique<Timer>();
+    std::unique_ptr<Timer> wheel = std::make_unique<Timer>();
+    int64_t                tick  = 0;  // 在时间轮中实际到期的 tick
+};
+
+}  // namespace
+
+// 以同样的随机操作驱动 TimerHeap 与 TimingWheel :
+// 堆按到期时间精确触发，时间轮不提前触发，且最多推迟一个精度
+// (加入时已过期的定时器在时间轮当前的 tick 触发)
+TEST_CASE("TimingWheel matches TimerHeap under random operations",
+          "[TimerStore]") {
+    const int64_t resolution = GENERATE(1, 7, 1000, 1000000);
+    std::mt19937_64 rng(static_cast<uint64_t>(resolution));
+    const Timestamp base(1700000000s);
+
+    TimerHeap   heap;
+    TimingWheel wheel(base, Nanoseconds(resolution));
+    std::map<int, TimerPair> live;
+    std::map<Timer*, int>    heapIds;
+    std::map<Timer*, int>    wheelIds;
+    std::set<int>            heapFired;  // 堆已触发、时间轮尚未触发的定时器
+    int64_t                  now     = 0;
+    int64_t                  current = 0;  // 时间轮第一个尚未处理的 tick
+    int                      nextId  = 0;
+
+    const auto randomDelay = [&rng](int maxBits) {
+        return static_cast<int64_t>(rng() % (int64_t(1) << (rng() % maxBits)));
+    };
+    const auto pick = [&rng, &live] {
+        auto it = live.begin();
+        std::advance(it, static_cast<long>(rng() % live.size()));
+        return it;
+    };
+    const auto ceilTick = [resolution](int64_t when) {
+        return when <= 0 ? 0 : (when + resolution - 1) / resolution;
+    };
+
+    for (int step = 0; step < 50000; ++step) {
+        // 到期时间最远约 2^44 ns，覆盖时间轮的高层与溢出链表
+        const int maxBits = 16 + (step % 3) * 14;
+        const int op      = static_cast<int>(rng() % 12);
+        if (op < 5) {
+            // 少数定时器加入时已经过期
+            const int64_t when =
+                now + randomDelay(maxBits) - (rng() % 5 == 0 ? 1000 : 0);
+            TimerPair pair;
+            pair.heap->setWhen(base + Nanoseconds(when));
+            pair.wheel->setWhen(base + Nanoseconds(when));
+            pair.tick = std::max(ceilTick(when), current);
+            heap.add(pair.heap.get());
+            wheel.add(pair.wheel.get());
+            heapIds[pair.heap.get()]   = nextId;
+            wheelIds[pair.wheel.get()] = nextId;
+            live.emplace(nextId++, std::move(pair));
+        }
+        else if (op < 6 && !live.empty()) {
+            auto it = pick();
+            heap.remove(it->second.heap.get());
+            wheel.remove(it->second.wheel.get());
+            heapFired.erase(it->first);
+            live.erase(it);
+        }
+        else if (op < 8 && !live.empty()) {
+            // 堆已触发的定时器会被重新加入，与时间轮保持一致
+            auto          it   = pick();
+            const int64_t when = now + randomDelay(maxBits);
+            heap.update(it->second.heap.get(), base + Nanoseconds(when));
+            wheel.update(it->second.wheel.get(), base + Nanoseconds(when));
+            it->second.tick = std::max(ceilTick(when), current);
+            heapFired.erase(it->first);
+        }
+        else {
+            Timestamp  heapDeadline;
+            Timestamp  wheelDeadline;
+            const bool hasHeap  = heap.nextDeadline(&heapDeadline);
+            const bool hasWheel = wheel.nextDeadline(&wheelDeadline);
+            REQUIRE(hasWheel == !live.empty());
+            if (hasWheel) {
+                int64_t earliest = INT64_MAX;
+                for (const auto& entry : live) {
+                    earliest = std::min(earliest, entry.second.tick);
+                }
+                REQUIRE(wheelDeadline - base <=
+                        Nanoseconds(earliest * resolution));
+            }
+            REQUIRE(hasHeap == (live.size() > heapFired.size()));
+            if (hasHeap) {
+                Timestamp earliest = Timestamp::max();
+                for (const auto& entry : live) {
+                    if (heapFired.count(entry.first) == 0) {
+                        earliest = std::min(earliest, entry.second.heap->when());
+                    }
+                }
+                REQUIRE(heapDeadline == earliest);
+            }
+
+            now += rng() % 3 == 0 ? randomDelay(maxBits)
+                                  : static_cast<int64_t>(
+                                        rng() % (resolution * 4 + 3));
+            TimerStore::TimerList expired;
+            heap.takeExpired(base + Nanoseconds(now), expired);
+            for (Timer* timer : expired) {
+                REQUIRE(timer->when() - base <= Nanoseconds(now));
+                REQUIRE(heapFired.insert(heapIds.at(timer)).second);
+            }
+            expired.clear();
+            wheel.takeExpired(base + Nanoseconds(now), expired);
+            const int64_t target = now / resolution;
+            for (Timer* timer : expired) {
+                const int id = wheelIds.at(timer);
+                REQUIRE(heapFired.erase(id) == 1);
+                REQUIRE(live.at(id).tick <= target);
+                live.erase(id);
+            }
+            current = std::max(current, target + 1);
+            for (const auto& entry : live) {
+                REQUIRE(entry.second.tick > target);
+            }
+            REQUIRE(wheel.size() == live.size());
+            REQUIRE(heap.size() == live.size() - heapFired.size());
+        }
+    }
+
+    TimerStore::TimerList all;
+    wheel.takeAll(all);
+    REQUIRE(all.size() == live.size());
+    for (Timer* timer : all) {
+        REQUIRE(live.count(wheelIds.at(timer)) == 1);
+    }
+    all.clear();
+    heap.takeAll(all);
+    REQUIRE(all.size() == live.size() - heapFired.size());
+}
@@ -0,0 +1,196 @@
+#include "core/Channel.h"
+#include "core/EventLoop.h"
+#include "core/Poller.h"
+#include "core/TcpConnection.h"
+#include "core/TcpServer.h"
+#include "logger/Logger.h"
+
+#include <catch2/catch.hpp>
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace libnet;
+
+namespace {
+
+// 作用域内新建的 EventLoop 使用 io_uring
+struct UseUring
+{
+    UseUring() { ::setenv("LIBNET_USE_URING", "1", 1); }
+    ~UseUring() { ::unsetenv("LIBNET_USE_URING"); }
+};
+
+// 内核不支持时 newDefaultPoller 退回 epoll
+bool uringAvailable(EventLoop& loop) {
+    if (::strcmp(loop.poller()->name(), "io_uring") != 0 ||
+        !loop.poller()->completionMode()) {
+        WARN("io_uring completion mode unavailable, skipped");
+        return false;
+    }
+    return true;
+}
+
+// 在客户端线程中调用，失败时返回 -1 (Catch2 的断言只能在测试线程中使用)
+int connectLoopback(uint16_t port) {
+    struct sockaddr_in addr = {};
+    addr.sin_family         = AF_INET;
+    addr.sin_port           = htons(port);
+    addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 &&
+        ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// 按偏移生成的数据，错位或被覆盖都能发现
+char patternAt(size_t offset) {
+    return static_cast<char>((offset * 7) ^ (offset >> 9));
+}
+
+}  // namespace
+
+// 水平触发的 channel 用单次 poll，每轮重新注册；边沿触发的用多次触发的 poll，
+// 同一轮中关闭又打开写事件后仍要重新注册，否则不会再次通知
+TEST_CASE("UringPoller re-arms channels re-enabled in one round",
+          "[UringPoller]") {
+    const bool edgeTriggered = GENERATE(true, false);
+    UseUring   useUring;
+    EventLoop  loop;
+    if (!uringAvailable(loop)) {
+        return;
+    }
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0,
+                         fds) == 0);
+    Channel channel(&loop, fds[0]);
+    int     writes = 0;
+
+    channel.setEdgeTriggered(edgeTriggered);
+    channel.setWriteCallback([&] {
+        if (++writes == 1) {
+            channel.disableWriting();
+            channel.enableWriting();
+        }
+        else {
+            loop.quit();
+        }
+    });
+    channel.enableWriting();
+    loop.runAfter(1s, [&] { loop.quit(); });
+
+    const Poller::Stats before = loop.poller()->stats();
+    loop.loop();
+    const Poller::Stats after = loop.poller()->stats();
+    channel.disableAll();
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    REQUIRE(writes == 2);
+    REQUIRE(after.ctlCalls == before.ctlCalls);
+}
+
+// 回显服务器 : 多次触发的 accept/recv 与 sendmsg，每条消息后 stopRead，
+// 由定时器 startRead，覆盖取消与重新提交 recv
+TEST_CASE("UringPoller echoes through completion-mode operations",
+          "[UringPoller]") {
+    Logger::setLogLevel(Logger::ERROR);
+    const uint16_t port     = 19805;
+    const size_t   dataSize = 8 * 1024 * 1024;
+
+    UseUring  useUring;
+    EventLoop loop;
+    if (!uringAvailable(loop)) {
+        return;
+    }
+    TcpServer server(&loop, InetAddress(port), false, 0s);
+    server.setNumThreads(1);
+
+    std::mutex       mutex;
+    TcpConnectionPtr conn;
+    std::atomic<int> pauses(0);
+    server.setConnectionCallback([&](const TcpConnectionPtr& c) {
+        std::lock_guard<std::mutex> lock(mutex);
+        conn = c;
+    });
+    server.setMessageCallback([&](const TcpConnectionPtr& c, Buffer& buffer) {
+        c->send(buffer);
+        buffer.retrieveAll();
+        if (++pauses % 8 == 0) {
+            c->stopRead();
+            std::weak_ptr<TcpConnection> weak(c);
+            c->getLoop()->runAfter(1ms, [weak] {
+                if (TcpConnectionPtr c = weak.lock()) {
+                    c->startRead();
+                }
+            });
+        }
+    });
+    server.start();
+
+    std::string output;
+    bool        written = true;
+    std::thread client([&] {
+        const int fd = connectLoopback(port);
+        if (fd >= 0) {
+            std::thread writer([&] {
+                std::string data(dataSize, '\0');
+                for (size_t i = 0; i < dataSize; ++i) {
+                    data[i] = patternAt(i);
+                }
+                for (size_t sent = 0; sent < dataSize;) {
+                    const ssize_t n =
+                        ::write(fd, data.data() + sent, dataSize - sent);
+                    if (n <= 0) {
+                        written = false;
+                        break;
+                    }
+                    sent += static_cast<size_t>(n);
+                }
+            });
+            char buf[65536];
+            while (output.size() < dataSize) {
+                const ssize_t n = ::read(fd, buf, sizeof buf);
+                if (n <= 0) {
+                    break;
+                }
+                output.append(buf, static_cast<size_t>(n));
+            }
+            writer.join();
+            ::close(fd);
+        }
+        // 等连接关闭后再析构 server
+        for (bool closed = false; !closed;) {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = !conn || conn->disconnected();
+        }
+        loop.runAfter(50ms, [&loop] { loop.quit(); });
+    });
+    loop.loop();
+    client.join();
+
+    REQUIRE(written);
+    REQUIRE(conn);
+    REQUIRE(conn->readSyscalls() == 0);  // 输入都来自多次触发的 recv
+    REQUIRE(conn->getLoop()->poller()->stats().completions > 0);
+    conn.reset();
+
+    REQUIRE(output.size() == dataSize);
+    size_t mismatch = 0;
+    while (mismatch < output.size() && output[mismatch] == patternAt(mismatch)) {
+        ++mismatch;
+    }
+    REQUIRE(mismatch == output.size());
+    REQUIRE(pauses > 8);
+}
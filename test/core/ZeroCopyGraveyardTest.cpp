@@ -0,0 +1,97 @@
+#include "core/ZeroCopyGraveyard.h"
+#include "core/EventLoop.h"
+
+#include <catch2/catch.hpp>
+
+#include <arpa/inet.h>
+#include <memory>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef SO_ZEROCOPY
+#    define SO_ZEROCOPY 60
+#endif
+
+using namespace libnet;
+
+namespace {
+
+// loopback 上一对已连接的 TCP socket，client 端非阻塞
+void tcpPair(int* client, int* server) {
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(listener >= 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family         = AF_INET;
+    addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+    socklen_t len           = sizeof(addr);
+    REQUIRE(::bind(listener, reinterpret_cast<sockaddr*>(&addr), len) == 0);
+    REQUIRE(::listen(listener, 1) == 0);
+    REQUIRE(::getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) ==
+            0);
+
+    *client = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    REQUIRE(*client >= 0);
+    ::connect(*client, reinterpret_cast<sockaddr*>(&addr), len);
+    *server = ::accept(listener, nullptr, nullptr);
+    REQUIRE(*server >= 0);
+    ::close(listener);
+}
+
+}  // namespace
+
+TEST_CASE("ZeroCopyGraveyard keeps holders until completion", "[ZeroCopy]") {
+    int client, server;
+    tcpPair(&client, &server);
+    int on = 1;
+    if (::setsockopt(client, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) != 0) {
+        ::close(client);
+        ::close(server);
+        WARN("SO_ZEROCOPY not supported, skipped");
+        return;
+    }
+
+    auto payload =
+        std::make_shared<const std::string>(std::string(256 * 1024, 'z'));
+    int         savedErrno = 0;
+    ssize_t     written    = 0;
+    std::string received;
+    bool        closed = false;
+    {
+        BufferChain chain;
+        chain.setZeroCopyThreshold(64 * 1024);
+        chain.append(payload);
+        written = chain.writeFd(client, &savedErrno);
+        REQUIRE(written > 0);
+        REQUIRE(chain.zeroCopySends() > 0);
+        REQUIRE(chain.pinnedCount() > 0);
+
+        EventLoop loop;
+        // 连接关闭 : chain 与其中的 holder 随之销毁，fd 交给 graveyard
+        loop.zeroCopyGraveyard().adopt(client, chain.takePinned());
+        // 对端不读时数据留在发送队列中，完成通知不会到达
+        REQUIRE(loop.zeroCopyGraveyard().size() == 1);
+        REQUIRE(payload.use_count() > 1);
+
+        // 对端开始读取，数据被确认后 graveyard 释放 holder 并关闭 fd
+        loop.runEvery(5ms, [&] {
+            char    buf[64 * 1024];
+            ssize_t n;
+            while ((n = ::recv(server, buf, sizeof buf, MSG_DONTWAIT)) > 0) {
+                received.append(buf, static_cast<size_t>(n));
+            }
+            closed = n == 0;
+            if (closed && loop.zeroCopyGraveyard().size() == 0) {
+                loop.quit();
+            }
+        });
+        loop.runAfter(5s, [&] { loop.quit(); });
+        loop.loop();
+        REQUIRE(loop.zeroCopyGraveyard().size() == 0);
+    }
+    REQUIRE(payload.use_count() == 1);
+    REQUIRE(closed);
+    ::close(server);
+    REQUIRE(received == payload->substr(0, static_cast<size_t>(written)));
+}
@@ -0,0 +1,137 @@
+#include "utils/MpscQueue.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace libnet;
+
+TEST_CASE("MpscQueue is FIFO", "[MpscQueue]") {
+    MpscQueue<int, 4> queue;
+    int               value = -1;
+    REQUIRE(queue.empty());
+    REQUIRE_FALSE(queue.pop(value));
+
+    // 超过节点缓存的容量，缓存满后的节点直接释放
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 10; ++i) {
+            queue.push(i);
+        }
+        REQUIRE_FALSE(queue.empty());
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE(queue.pop(value));
+            REQUIRE(value == i);
+        }
+        REQUIRE(queue.empty());
+        REQUIRE_FALSE(queue.pop(value));
+    }
+}
+
+TEST_CASE("MpscQueue holds move-only values", "[MpscQueue]") {
+    auto counter = std::make_shared<int>(0);
+    {
+        MpscQueue<std::shared_ptr<int>, 2> queue;
+        for (int i = 0; i < 5; ++i) {
+            queue.push(std::shared_ptr<int>(counter));
+        }
+        REQUIRE(counter.use_count() == 6);
+
+        std::shared_ptr<int> value;
+        REQUIRE(queue.pop(value));
+        value.reset();
+        REQUIRE(counter.use_count() == 5);
+    }
+    // 析构时释放队列中剩余的元素
+    REQUIRE(counter.use_count() == 1);
+
+    MpscQueue<std::unique_ptr<int>> queue;
+    queue.push(std::make_unique<int>(42));
+    std::unique_ptr<int> value;
+    REQUIRE(queue.pop(value));
+    REQUIRE(*value == 42);
+}
+
+TEST_CASE("MpscQueue consume takes a snapshot", "[MpscQueue]") {
+    MpscQueue<int> queue;
+    for (int i = 0; i < 5; ++i) {
+        queue.push(i);
+    }
+
+    SECTION("values pushed by the callback are left for the next call") {
+        std::vector<int> seen;
+        queue.consume([&](int value) {
+            seen.push_back(value);
+            queue.push(value + 100);
+            return true;
+        });
+        REQUIRE(seen == std::vector<int>{ 0, 1, 2, 3, 4 });
+
+        seen.clear();
+        queue.consume([&](int value) {
+            seen.push_back(value);
+            return true;
+        });
+        REQUIRE(seen == std::vector<int>{ 100, 101, 102, 103, 104 });
+        REQUIRE(queue.empty());
+    }
+
+    SECTION("returning false stops early") {
+        std::vector<int> seen;
+        queue.consume([&](int value) {
+            seen.push_back(value);
+            return value < 2;
+        });
+        REQUIRE(seen == std::vector<int>{ 0, 1, 2 });
+
+        int value = -1;
+        REQUIRE(queue.pop(value));
+        REQUIRE(value == 3);
+    }
+}
+
+TEST_CASE("MpscQueue with concurrent producers", "[MpscQueue]") {
+    const int kProducers   = 4;
+    const int kPerProducer = 100000;
+
+    // 高 32 位为生产者编号，低 32 位为序号
+    MpscQueue<uint64_t, 8>   queue;
+    std::atomic<int>         ready(0);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            ready.fetch_add(1);
+            while (ready.load() < kProducers) {
+            }
+            for (uint64_t i = 0; i < kPerProducer; ++i) {
+                queue.push((static_cast<uint64_t>(p) << 32) | i);
+            }
+        });
+    }
+
+    // 每个生产者的元素按顺序到达，不丢失也不重复
+    std::vector<uint64_t> next(kProducers, 0);
+    int                   received = 0;
+    uint64_t              value;
+    while (received < kProducers * kPerProducer) {
+        if (!queue.pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const auto producer = static_cast<size_t>(value >> 32);
+        REQUIRE(producer < next.size());
+        REQUIRE((value & 0xffffffffu) == next[producer]);
+        ++next[producer];
+        ++received;
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    REQUIRE_FALSE(queue.pop(value));
+    for (uint64_t n : next) {
+        REQUIRE(n == kPerProducer);
+    }
+}
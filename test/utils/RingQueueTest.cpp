@@ -0,0 +1,67 @@
+#include "utils/RingQueue.h"
+
+#include <catch2/catch.hpp>
+
+#include <deque>
+#include <memory>
+#include <random>
+
+using namespace libnet;
+
+// 以同样的随机操作驱动 RingQueue 与 std::deque，跨过环的末尾与多次扩容
+TEST_CASE("RingQueue matches std::deque", "[RingQueue]") {
+    std::mt19937    rng(7);
+    RingQueue<int>  ring;
+    std::deque<int> expected;
+    int             next = 0;
+
+    for (int step = 0; step < 20000; ++step) {
+        const unsigned op = rng() % 8;
+        if (op < 4 || expected.empty()) {
+            REQUIRE(ring.emplace_back(next) == next);
+            expected.push_back(next++);
+        }
+        else if (op < 7) {
+            REQUIRE(ring.front() == expected.front());
+            ring.pop_front();
+            expected.pop_front();
+        }
+        else {
+            REQUIRE(ring.back() == expected.back());
+            ring.pop_back();
+            expected.pop_back();
+        }
+        REQUIRE(ring.size() == expected.size());
+        if (step % 97 == 0) {
+            size_t index = 0;
+            for (int value : ring) {
+                REQUIRE(value == expected[index]);
+                REQUIRE(ring[index] == value);
+                ++index;
+            }
+            REQUIRE(index == expected.size());
+        }
+    }
+}
+
+TEST_CASE("RingQueue reuses its slots and destroys elements",
+          "[RingQueue]") {
+    auto counter = std::make_shared<int>(0);
+    {
+        RingQueue<std::shared_ptr<int>> ring;
+        for (int i = 0; i < 5; ++i) {
+            ring.emplace_back(counter);
+        }
+        const size_t capacity = ring.capacity();
+        // 一端进一端出，元素个数不变时不再扩容
+        for (int i = 0; i < 1000; ++i) {
+            ring.emplace_back(counter);
+            ring.pop_front();
+        }
+        REQUIRE(ring.capacity() == capacity);
+        REQUIRE(counter.use_count() == 6);
+        ring.pop_back();
+        REQUIRE(counter.use_count() == 5);
+    }
+    REQUIRE(counter.use_count() == 1);
+}